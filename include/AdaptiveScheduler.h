@@ -0,0 +1,69 @@
+/****************************************************************/
+/*                   AdaptiveScheduler (Header)                 */
+/*                           Blake Owen                         */
+/*        Per-object update intervals for per-frame positions.  */
+/*        Each object is re-propagated only when its interval   */
+/*        has elapsed; in between, its cached state is          */
+/*        extrapolated with a second-order Taylor step.         */
+/****************************************************************/
+
+#include <atomic>
+#include <vector>
+
+#include "Sgp4.h"
+#include "ThreadPool.h"
+#include "gl.h"
+
+#pragma once
+
+using namespace std;
+
+class AdaptiveScheduler {
+    public:
+    // sats[i] is the initialized state of the object in render slot i; pool may be null
+    AdaptiveScheduler(const vector<Sgp4Sat>& sats, ThreadPool* pool);
+
+    // Largest extrapolation error allowed before an object is due (km)
+    void setToleranceKm(double km);
+    double getToleranceKm() const {return toleranceKm;}
+
+    // Simulation seconds per rendered frame (frame time * 10^simSpeed). Intervals are
+    // whole numbers of frames; anything faster than one frame is updated every frame.
+    void setSimSecondsPerFrame(double seconds);
+
+    // Write every object at ds50UTC as (x, z, y) / kmPerUnit into points[slot * 3]
+    void propagateAll(double ds50UTC, GLfloat* points, double kmPerUnit);
+
+    // Objects actually propagated by the last propagateAll call; pending objects are not
+    int lastPropagatedCount() const {return propagatedCount.load();}
+
+    // Objects that are propagated on every frame at the current rate; safe from any thread
+    int everyFrameCount() const {return numEveryFrame.load();}
+
+    int size() const {return sats.size();}
+
+    // Switch one slot to a new element set; it is propagated again on the next call
+    void replace(int slot, const Sgp4Sat& sat);
+
+    private:
+    void updateIntervals();
+    double intervalFor(const Sgp4Sat& sat) const;
+    bool isEveryFrame(double dt) const {return dt <= simSecondsPerFrame / 86400.0 * 1.5;}
+
+    vector<Sgp4Sat> sats;
+    ThreadPool* pool;
+    double toleranceKm = 0.5;
+    double simSecondsPerFrame = 1.0 / 60.0;
+
+    // Per object: update interval (days), time of the cached state, when it is next due
+    // and the state itself (km, km/s)
+    vector<double> interval;
+    vector<double> lastTime;
+    vector<double> nextDue;
+    vector<double> state;    // [slot][6]
+    vector<char> hasState;
+
+    vector<int> chunkCounts;
+    atomic<int> propagatedCount;
+    atomic<int> numEveryFrame;
+};
@@ -0,0 +1,61 @@
+/****************************************************************/
+/*                     CatalogFilter (Header)                   */
+/*                           Blake Owen                         */
+/*        Load-time selection of element sets by orbit and      */
+/*        id. The parsers test every set as it is read, so      */
+/*        rejected objects never reach the catalog, the         */
+/*        propagators or the point buffer.                      */
+/****************************************************************/
+
+#include <string>
+#include <vector>
+
+#include "Sgp4.h"
+
+#pragma once
+
+using namespace std;
+
+// An expression is a list of clauses separated by spaces or ';', all of which must hold:
+//
+//     perigee<2000 incl=50..60 ecc<0.1 age<=30 id=25544,40000-41000 id!=20580
+//
+// Fields: perigee, apogee (km altitude), incl (deg), ecc, period (min), age (days
+// before the reference time) and id (NORAD number). Operators: < <= > >= = !=.
+// '=' and '!=' take a comma-separated list of values and lo..hi ranges (lo-hi for id).
+class CatalogFilter {
+    public:
+    // Replace the filter; on a syntax error returns false with a message and keeps the old one
+    bool parse(const string& expression, string& error);
+    void clear();
+
+    bool isEmpty() const {return clauses.empty();}
+    const string& text() const {return expression;}
+
+    // Time ages are measured from (ds50 UTC)
+    void setReferenceTime(double ds50UTC) {referenceTime = ds50UTC;}
+    double getReferenceTime() const {return referenceTime;}
+    bool usesAge() const;
+
+    bool accepts(const TleElements& el) const;
+
+    private:
+    enum Field {FIELD_PERIGEE, FIELD_APOGEE, FIELD_INCL, FIELD_ECC, FIELD_PERIOD, FIELD_AGE, FIELD_ID};
+
+    // Inclusive bounds; strict comparisons are stored as the next representable value
+    struct Range {
+        double low;
+        double high;
+    };
+
+    struct Clause {
+        Field field;
+        bool negate;
+        vector<Range> ranges;
+    };
+
+    string expression;
+    vector<Clause> clauses;
+    bool needsAltitudes = false;
+    double referenceTime = 0.0;
+};
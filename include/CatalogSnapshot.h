@@ -0,0 +1,71 @@
+/****************************************************************/
+/*                   CatalogSnapshot (Header)                   */
+/*                           Blake Owen                         */
+/*        Versioned binary image of a parsed and initialized    */
+/*        catalog. Written once after a full TLE load; later    */
+/*        starts memory-map it and copy the records out, so     */
+/*        nothing is parsed or initialized again.               */
+/****************************************************************/
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "CatalogFilter.h"
+#include "Sgp4.h"
+#include "MappedFile.h"
+
+#pragma once
+
+using namespace std;
+
+// Bump whenever TleElements, Sgp4Sat or the file layout changes
+const uint32_t CATALOG_SNAPSHOT_VERSION = 3;
+
+// Fixed-size file header; every section offset is a multiple of 64 bytes
+struct CatalogSnapshotHeader {
+    char magic[8];                // "SDTSNAP"
+    uint32_t version;
+    uint32_t byteOrder;           // 0x01020304 as written by the producing machine
+    uint32_t satRecordSize;       // sizeof(Sgp4Sat)
+    uint32_t elementRecordSize;   // sizeof(TleElements)
+    uint64_t sourceFingerprint;   // sourceFingerprint() of the TLE files it was built from
+    uint64_t count;
+    uint64_t satsOffset;          // Sgp4Sat[count]
+    uint64_t elementsOffset;      // TleElements[count]
+    uint64_t historyCount;
+    uint64_t historyOffset;       // TleElements[historyCount], every set parsed, load order
+    uint64_t fileSize;
+};
+
+class CatalogSnapshot {
+    public:
+    // Hash of the name, size and modification time (to the nanosecond where the platform
+    // records it) of every source file, of the time used to pick one element set per object
+    // and of the load filter
+    static uint64_t sourceFingerprint(const vector<const char*>& files, double analysisTime, const CatalogFilter& filter);
+
+    // Write elements[i] / sats[i] as record i, plus every parsed set (history) for time-travel
+    // replay. The file is written beside fileName and renamed into place, so a reader never
+    // maps a partial snapshot.
+    static bool write(const char* fileName, uint64_t fingerprint, const vector<TleElements>& elements,
+                      const vector<Sgp4Sat>& sats, const vector<TleElements>& history);
+
+    // Map a snapshot; fails (and stays closed) if it is missing, from another build or
+    // version, truncated, or was built from different source files
+    bool open(const char* fileName, uint64_t fingerprint);
+    void close();
+
+    bool isOpen() const {return header != nullptr;}
+    int size() const {return header != nullptr ? (int)header->count : 0;}
+
+    // Views into the mapping; valid until close()
+    const Sgp4Sat* sats() const {return reinterpret_cast<const Sgp4Sat*>(file.data() + header->satsOffset);}
+    const TleElements* elements() const {return reinterpret_cast<const TleElements*>(file.data() + header->elementsOffset);}
+    int historySize() const {return header != nullptr ? (int)header->historyCount : 0;}
+    const TleElements* history() const {return reinterpret_cast<const TleElements*>(file.data() + header->historyOffset);}
+
+    private:
+    MappedFile file;
+    const CatalogSnapshotHeader* header = nullptr;
+};
@@ -0,0 +1,124 @@
+/****************************************************************/
+/*                   EphemerisCache (Header)                    */
+/*                           Blake Owen                         */
+/*        Piecewise Chebyshev fits of every satellite over a    */
+/*        sliding time window. Windows are fitted in the        */
+/*        background from the native SGP4 state; evaluating a   */
+/*        frame is then a low-order polynomial per object.      */
+/****************************************************************/
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Sgp4.h"
+#include "ThreadPool.h"
+#include "gl.h"
+
+#pragma once
+
+using namespace std;
+
+struct EphemerisStats {
+    unsigned long long hits;     // frames answered from the cache
+    unsigned long long misses;   // frames outside the fitted window
+    unsigned long long refits;   // windows fitted
+    double maxErrorKm;           // worst check-point error of the current window
+    double lastFitSeconds;       // wall time of the last fit
+    double windowStart;          // ds50 UTC
+    double windowEnd;            // ds50 UTC
+    double requestedDays;        // window length asked for; longer than the fitted one when capped
+    long long segments;          // fitted segments across every satellite
+    double coeffMb;              // memory held by the current window's coefficients
+};
+
+class EphemerisCache {
+    public:
+    EphemerisCache();
+    ~EphemerisCache();
+
+    EphemerisCache(const EphemerisCache&) = delete;
+    EphemerisCache& operator=(const EphemerisCache&) = delete;
+
+    // Pool the fits run on, or null to fit on the cache's own thread. Typically
+    // TLEReader::getThreadPool(); call before the first request().
+    void setThreadPool(ThreadPool* pool);
+
+    // Satellites to fit; slots[i] is the render slot of sats[i]. Drops the current window.
+    void setCatalog(const vector<Sgp4Sat>& sats, const vector<int>& slots);
+
+    // Switch the given render slots to new element sets. The current window keeps its fits;
+    // the new sets are used from the next refit on.
+    void updateSatellites(const vector<int>& slots, const vector<Sgp4Sat>& sats);
+
+    // Maximum position error accepted at the check points between fit nodes
+    void setToleranceKm(double km);
+    double getToleranceKm() const {return toleranceKm;}
+
+    // Length of the window fitted by the next refit. Windows are shortened as needed to
+    // keep the coefficients within EPHEM_MAX_COEFF_MB.
+    void setWindowDays(double days);
+    double getWindowDays() const {return windowDays;}
+
+    // Write every object at ds50UTC as (x, z, y) / kmPerUnit into points[slot * 3].
+    // Returns false when ds50UTC is outside the fitted window; a refit is then queued
+    // and the caller should propagate directly for this frame.
+    bool evaluate(double ds50UTC, GLfloat* points, double kmPerUnit);
+
+    // Whether the fitted window contains ds50UTC, so evaluate() answers it without a refit
+    bool covers(double ds50UTC);
+
+    // Queue a background fit of a window starting at ds50UTC
+    void request(double ds50UTC);
+
+    EphemerisStats getStats();
+
+    private:
+    struct Catalog {
+        vector<Sgp4Sat> sats;
+        vector<int> slots;
+    };
+
+    // Fitted coefficients for one window
+    struct Window {
+        shared_ptr<const Catalog> catalog;
+        double start, end;
+        double requestedDays;
+        double maxErrorKm;
+        vector<double> span;      // segment length per satellite (days)
+        vector<int> numSegments;  // 0 when the satellite could not be propagated
+        vector<size_t> offset;    // first coefficient of each satellite
+        vector<double> coeffs;    // [segment][axis][degree + 1]
+    };
+
+    void workerLoop();
+    void queue(double ds50UTC);
+    bool queuedCovers(double ds50UTC) const;
+    shared_ptr<Window> fit(const shared_ptr<const Catalog>& cat, double start, double days, double tolerance, ThreadPool* workers);
+    double fitSatellite(const Sgp4Sat& sat, double start, double days, double span, vector<double>& out);
+    shared_ptr<const Window> current();
+    bool evaluateOne(const Window& w, int i, double ds50UTC, double r[3]) const;
+
+    double toleranceKm = 0.1;
+    double windowDays = 1.0 / 24.0;
+
+    ThreadPool* pool = nullptr;
+    thread worker;
+    mutex lock;
+    condition_variable wake;
+    bool stopping = false;
+    bool pending = false;
+    bool fitting = false;
+    double pendingStart = 0.0;
+    shared_ptr<const Catalog> catalog;
+    shared_ptr<const Window> window;
+    vector<pair<int, Sgp4Sat>> pendingUpdates;   // applied by the worker before its next fit
+
+    atomic<unsigned long long> hits;
+    atomic<unsigned long long> misses;
+    atomic<unsigned long long> refits;
+    double lastFitSeconds = 0.0;
+};
@@ -0,0 +1,73 @@
+/****************************************************************/
+/*                    EphemerisTable (Header)                   */
+/*                           Blake Owen                         */
+/*        Positions of every object at every timestep of a      */
+/*        screening window in one contiguous array. Each        */
+/*        satellite is propagated across all timesteps while    */
+/*        its state is hot, in the spirit of Sgp4GenEphems.     */
+/****************************************************************/
+
+#include <functional>
+#include <vector>
+
+#include "PropagatorContext.h"
+#include "Sgp4.h"
+#include "ThreadPool.h"
+
+#pragma once
+
+using namespace std;
+
+// Array order of the generated table
+enum EphemerisLayout {
+    EPHEM_SAT_MAJOR,    // [sat][t]: one object's track is contiguous
+    EPHEM_TIME_MAJOR    // [t][sat]: one timestep's snapshot is contiguous
+};
+
+class EphemerisTable {
+    public:
+    // Size the table; every entry starts invalid
+    void resize(int numSats, double startDs50UTC, double stepMinutes, int numSteps, EphemerisLayout layout);
+
+    // Propagate every satellite over the table's timesteps; pool may be null
+    void generate(const vector<Sgp4Sat>& sats, double startDs50UTC, double stepMinutes, int numSteps,
+                  EphemerisLayout layout, ThreadPool* pool = nullptr);
+
+    // Same for the given render slots of a context, row i holding slots[i]. Needs no lock,
+    // so it can run on any thread while the renderer keeps propagating.
+    void generate(const PropagatorContext& context, const vector<int>& slots, double startDs50UTC,
+                  double stepMinutes, int numSteps, EphemerisLayout layout, ThreadPool* pool = nullptr);
+
+    // Store one entry (TEME, km)
+    void set(int sat, int step, const double pos[3], bool ok);
+
+    int satCount() const {return numSats;}
+    int stepCount() const {return numSteps;}
+    EphemerisLayout getLayout() const {return layout;}
+    double timeAt(int step) const {return start + step * stepMinutes / 1440.0;}
+
+    size_t index(int sat, int step) const {
+        return layout == EPHEM_SAT_MAJOR ? (size_t)sat * numSteps + step : (size_t)step * numSats + sat;
+    }
+
+    // Position (TEME, km) and whether propagation succeeded
+    const double* position(int sat, int step) const {return &positions[index(sat, step) * 3];}
+    bool isValid(int sat, int step) const {return valid[index(sat, step)] != 0;}
+
+    // Raw arrays in the table's layout, 3 doubles / 1 flag per entry
+    const double* data() const {return positions.data();}
+    const unsigned char* validity() const {return valid.data();}
+
+    private:
+    // Fill every row from sat(row) across the pool
+    void sweep(const function<const Sgp4Sat&(int)>& sat, ThreadPool* pool);
+
+    int numSats = 0;
+    int numSteps = 0;
+    double start = 0.0;
+    double stepMinutes = 0.0;
+    EphemerisLayout layout = EPHEM_SAT_MAJOR;
+
+    vector<double> positions;
+    vector<unsigned char> valid;
+};
@@ -0,0 +1,19 @@
+/****************************************************************/
+/*                       FileList (Header)                      */
+/*                           Blake Owen                         */
+/*        Expands a directory or a wildcard pattern into the    */
+/*        files it names, in name order, so daily archives      */
+/*        load chronologically.                                 */
+/****************************************************************/
+
+#include <string>
+#include <vector>
+
+#pragma once
+
+using namespace std;
+
+// Append the files named by path: every regular file in a directory, the matches of a
+// pattern with '*' or '?' (and '[...]' outside Windows) in its last component, or path
+// itself. Matches are sorted by name. Returns false when nothing was found.
+bool expandPath(const string& path, vector<string>& files);
@@ -0,0 +1,48 @@
+/****************************************************************/
+/*                      FileWatcher (Header)                    */
+/*                           Blake Owen                         */
+/*        Background thread that reports source files written   */
+/*        or moved into place after startup. Uses inotify on    */
+/*        Linux and polls modification times elsewhere.         */
+/****************************************************************/
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#pragma once
+
+using namespace std;
+
+class FileWatcher {
+    public:
+    // Called on the watcher thread with the changed files, in name order
+    typedef function<void(const vector<string>&)> ChangeHandler;
+
+    ~FileWatcher();
+
+    // Watch the files named by sources (files, directories or patterns, as for expandPath).
+    // Writes are collected until the files have been quiet for a moment, so one batch covers
+    // a whole download. Returns false when nothing could be watched.
+    bool start(const vector<string>& sources, ChangeHandler onChange);
+    void stop();
+
+    bool isRunning() const {return running.load();}
+
+    private:
+    void watchLoop();
+    void pollLoop();
+
+    // Files currently named by the sources that are also in changed
+    vector<string> matchSources(const vector<string>& changed) const;
+
+    vector<string> sources;
+    ChangeHandler onChange;
+    thread watcher;
+    atomic<bool> running{false};
+    int notifyFd = -1;
+    vector<pair<int, string>> watches;    // inotify watch descriptor and directory
+};
@@ -0,0 +1,85 @@
+/****************************************************************/
+/*                        KdTree (Header)                       */
+/*                           Blake Owen                         */
+/*        Balanced k-d tree over debris positions for nearest   */
+/*        neighbour and radius queries. Nodes are implicit      */
+/*        (heap order) and every leaf is a contiguous bucket    */
+/*        of at most LEAF_SIZE points. Builds level by level    */
+/*        and answers batches on an optional worker pool.       */
+/****************************************************************/
+
+#include <cstdint>
+#include <vector>
+
+#include "SpaceDebris.h"
+#include "ThreadPool.h"
+
+#pragma once
+
+using namespace std;
+
+// A point found by a query: its index in the debris list and its distance
+struct KdNeighbour {
+    int index;
+    double distance;
+};
+
+class KdTree {
+
+public:
+
+    static const int LEAF_SIZE = 16;
+
+    KdTree(const vector<SpaceDebris>& debris_list, ThreadPool* pool = nullptr);
+
+    // The k points nearest (x, y, z), closest first. Points exactly at the query position
+    // are skipped, so querying with a catalog object returns its neighbours, not itself.
+    void knn(double x, double y, double z, int k, vector<KdNeighbour>& result) const;
+
+    // Every point within radius of (x, y, z), excluding the query position itself, unordered
+    void radius(double x, double y, double z, double radius, vector<KdNeighbour>& result) const;
+
+    // The k nearest neighbours of every object: result[i * k + j] is object i's (j+1)th nearest,
+    // index -1 when the catalog has fewer than k other points
+    void knn_all(int k, vector<KdNeighbour>& result) const;
+
+    // Every distinct pair no further apart than radius (indices into the debris list)
+    void find_pairs(double radius, vector<DebrisPair>& pairs) const;
+
+    // Objects whose nearest neighbour is within tolerance, each with that neighbour
+    void find_risky_debris(double tolerance, vector<SpaceDebris>& riskList) const;
+
+    int size() const {return points.size();}
+
+private:
+
+    struct Point {
+        double x, y, z;
+        int index;
+    };
+
+    vector<SpaceDebris> debris_list;
+
+    ThreadPool* pool;
+
+    // Objects in leaf order; node i covers points [nodeBegin[i], nodeEnd[i]) and has children
+    // 2i+1 and 2i+2 unless it is at leafDepth
+    vector<Point> points;
+    vector<int> nodeBegin;
+    vector<int> nodeEnd;
+    vector<uint8_t> splitAxis;
+    vector<double> splitValue;
+    // Region of each node (low xyz, high xyz): the root's bounds cut by the splits above it
+    vector<double> nodeBox;
+    int leafDepth;
+    int firstLeaf;
+
+    void split_node(int node);
+
+    void search_knn(int node, const double query[3], int k, vector<KdNeighbour>& heap) const;
+
+    void search_radius(int node, const double query[3], double radius2, vector<KdNeighbour>& result) const;
+
+    // Run task(c) for c in [0, numTasks) on the pool, or serially without one
+    void run(int numTasks, const function<void(int)>& task) const;
+};
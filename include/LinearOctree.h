@@ -0,0 +1,56 @@
+/****************************************************************/
+/*                     LinearOctree (Header)                    */
+/*                           Blake Owen                         */
+/*        Pointer-free octree for conjunction screening.        */
+/*        Objects are Morton-encoded on a grid of tolerance-    */
+/*        wide leaves and radix-sorted; each leaf is a run of   */
+/*        equal keys. Every pair within tolerance is found,     */
+/*        including pairs that straddle a leaf boundary.        */
+/****************************************************************/
+
+#include <cstdint>
+#include <vector>
+
+#include "SpaceDebris.h"
+
+#pragma once
+
+using namespace std;
+
+class LinearOctree {
+
+public:
+
+    LinearOctree(const vector<SpaceDebris>& debris_list, double tolerance);
+
+    // Every distinct pair no further apart than tolerance (indices into the debris list)
+    void find_pairs(vector<DebrisPair>& pairs) const;
+
+    // One entry per object in a pair, with its closest partner
+    void find_risky_debris(vector<SpaceDebris>& riskList) const;
+
+    int leafCount() const {return leafKeys.size();}
+
+private:
+
+    vector<SpaceDebris> debris_list;
+
+    double tolerance;
+
+    // Leaf width; the tolerance unless the catalog spans more than 2^21 of them per axis
+    double leafSize;
+
+    // Leaves in Morton order and the range of sorted objects each holds
+    vector<uint64_t> leafKeys;
+    vector<int> leafStart;
+
+    // Objects in Morton order: debris index and position
+    vector<int> order;
+    vector<double> xs, ys, zs;
+
+    void compare_leaves(int a, int b, vector<DebrisPair>& pairs) const;
+};
+
+// Interleave three 21-bit cell coordinates, x in the lowest bit
+uint64_t mortonEncode(uint32_t x, uint32_t y, uint32_t z);
+void mortonDecode(uint64_t key, uint32_t& x, uint32_t& y, uint32_t& z);
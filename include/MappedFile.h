@@ -0,0 +1,40 @@
+/****************************************************************/
+/*                     MappedFile (Header)                      */
+/*                           Blake Owen                         */
+/*        Read-only memory mapping of a whole file. The pages   */
+/*        are shared with the OS file cache, so readers parse   */
+/*        the bytes in place without copying them.              */
+/****************************************************************/
+
+#include <cstddef>
+
+#pragma once
+
+using namespace std;
+
+class MappedFile {
+    public:
+    MappedFile() {}
+    ~MappedFile() {close();}
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map fileName read-only; returns false (and stays closed) on failure. Empty files map to size 0.
+    bool open(const char* fileName);
+    void close();
+
+    bool isOpen() const {return opened;}
+    const char* data() const {return bytes;}
+    size_t size() const {return length;}
+
+    private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+    bool opened = false;
+
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
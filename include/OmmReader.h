@@ -0,0 +1,42 @@
+/****************************************************************/
+/*                      OmmReader (Header)                      */
+/*                           Blake Owen                         */
+/*        Streaming reader for CCSDS Orbit Mean-Elements        */
+/*        Messages in the KVN, CSV and XML encodings. Files     */
+/*        pass through one fixed-size buffer and every message  */
+/*        becomes a TleElements as soon as it is complete, so   */
+/*        documents of any size load in constant memory.        */
+/****************************************************************/
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "CatalogFilter.h"
+#include "Sgp4.h"
+
+#pragma once
+
+using namespace std;
+
+enum OmmFormat {OMM_NONE, OMM_KVN, OMM_CSV, OMM_XML};
+
+struct OmmReadStats {
+    int sets = 0;          // element sets appended
+    int rejected = 0;      // messages missing a required field, with a bad value or a non-SGP4 theory
+    int filtered = 0;      // valid, but not accepted by the filter
+    size_t bytes = 0;      // bytes read
+    string firstError;     // why the first rejected message was rejected
+};
+
+// Encoding of a document from its first bytes; OMM_NONE for anything else (e.g. TLE text)
+OmmFormat detectOmmFormat(const char* head, size_t length);
+
+// detectOmmFormat on the start of a file; OMM_NONE if it cannot be read
+OmmFormat detectOmmFile(const char* fileName);
+
+// Append one element set per SGP4 message in an OMM file. NORAD_CAT_ID may be a plain
+// number of any width or a five-character Alpha-5 id. With a filter, only the sets it
+// accepts are appended.
+OmmReadStats readOmmFile(const char* fileName, OmmFormat format, vector<TleElements>& elements,
+                         const CatalogFilter* filter = nullptr);
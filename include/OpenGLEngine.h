@@ -26,10 +26,30 @@
 #include <unordered_set>
 
 #include "TLEReader.h"
+#include "EphemerisCache.h"
+#include "PropagationPipeline.h"
+#include "StartupProfiler.h"
+#include <atomic>
+#include <thread>
 #include "SpaceDebris.h"
+#include "LinearOctree.h"
+#include "SpatialHashGrid.h"
+#include "KdTree.h"
+#include "SortAndSweep.h"
+#include "OrbitShellFilter.h"
+#include "WindowScreener.h"
 
 #pragma once
 
+// Risk detection algorithms, in radio button order
+enum RiskAlgorithm {
+    RISK_OCTREE = 0,
+    RISK_ITERATIVE = 1,
+    RISK_HASH_GRID = 2,
+    RISK_KD_TREE = 3,
+    RISK_SORT_AND_SWEEP = 4
+};
+
 struct xyz {
     float x;
     float y;
@@ -44,6 +64,15 @@ class OpenGLEngine {
     // Window
     GLFWwindow* window;
 
+    // TLE/3LE file, directory or pattern to load instead of the bundled files; call before init()
+    void addTleSource(const char* path) {tle.addSource(path);}
+    // Load only the element sets an expression such as "perigee<2000 incl=50..60" accepts;
+    // call before init(). Returns false on a syntax error.
+    bool setCatalogFilter(const char* expression);
+    // Algorithm the Run button uses
+    void setRiskAlgorithm(RiskAlgorithm algorithm) {algorithmSelection = algorithm;}
+    // Also write the startup phase table to this JSON file; call before init()
+    void setStartupProfileFile(const char* fileName) {profiler.setJsonFile(fileName);}
     void init();
 
     void preFrame(double frameTime);
@@ -64,11 +93,28 @@ class OpenGLEngine {
     void shutdown();
 
     private:
+    void startCatalogServices(double time);
+    // Publish reloaded sets and history switches for time and pass them on to the ephemeris
+    // cache; called under the pipeline, before every tle.propagate()
+    void updateHistory(double time);
+    void finishStartup();
+    // Window screening on screeningThread; leaves its risk list in screeningResult
+    void screenWindowJob(double start, double stepMinutes, int numSteps, double padKm, double toleranceKm);
+
     // Constants
     const int   WINDOW_WIDTH    = 1280;
     const int   WINDOW_HEIGHT   = 720;
     const float CAMERA_DISTANCE = 4.0f;
 
+    // Load every propagation backend at startup and keep the fastest
+    const bool  BENCHMARK_BACKENDS = false;
+
+    // Print wall time, CPU time, counts and peak RSS of each startup phase
+    const bool  PROFILE_STARTUP = true;
+
+    // Pick up rewritten or newly downloaded TLE files without restarting
+    const bool  WATCH_TLE_FILES = true;
+
     // Global Variables
     int windowWidth;
     int windowHeight;
@@ -136,6 +182,10 @@ class OpenGLEngine {
     // Objects
     Sphere earth;
 
+    // Startup phases; declared before tle, whose init thread records into it
+    StartupProfiler profiler;
+    atomic<int> startupPending;   // init() and, with lazy initialization, the last published batch
+
     TLEReader tle;
 
     // Point arrays
@@ -152,11 +202,40 @@ class OpenGLEngine {
     float* tolerance;
     int* iterations;
 
+    // Window screening: altitude shell padding, window length and timestep
+    float* shellPad;
+    float* windowHours;
+    float* windowStep;
+
+    // Window screening runs off the render thread; frame() picks up the result once done
+    thread screeningThread;
+    atomic<bool> screeningDone;
+    atomic<bool> screeningCancel;
+    vector<SpaceDebris> screeningResult;   // written by the job before screeningDone is set
+
     int numSats;
     double epoch;
     int simSpeed;
     bool isPaused;
 
+    // Chebyshev ephemeris used for per-frame positions
+    EphemerisCache ephemeris;
+    bool useEphemeris;
+    atomic<bool> ephemerisActive;   // copy of useEphemeris read by the producer thread
+    float* ephemerisTolerance;
+
+    // Ephemeris and file watching are running; set on the producer thread after lazy init
+    bool catalogReady;
+
+    // Adaptive per-object update rates and the objects propagated for the newest frame
+    bool useAdaptive;
+    float* adaptiveTolerance;
+    atomic<int> framePropagated;
+
+    // Background propagation; declared after tle and ephemeris so it is destroyed first
+    vector<SpaceDebris> producerDebris;
+    PropagationPipeline pipeline;
+
     // Current selected algorithm for risk assessment
     int algorithmSelection;
     
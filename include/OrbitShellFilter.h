@@ -0,0 +1,62 @@
+/****************************************************************/
+/*                   OrbitShellFilter (Header)                  */
+/*                           Blake Owen                         */
+/*        Altitude-shell pre-filter for conjunction screening.  */
+/*        Two objects can only meet if their perigee-to-apogee  */
+/*        ranges overlap, so pairs whose padded shells are      */
+/*        disjoint are dropped before anything is propagated.   */
+/****************************************************************/
+
+#include <utility>
+#include <vector>
+
+#include "Sgp4.h"
+#include "ThreadPool.h"
+
+#pragma once
+
+using namespace std;
+
+class OrbitShellFilter {
+    public:
+    // Shells of every element set, [perigee - padKm, apogee + padKm], found with an interval
+    // sweep over the shells sorted by their lower bound. Indices are positions in elements
+    // (render slots for the catalog).
+    void build(const vector<TleElements>& elements, double padKm, ThreadPool* pool = nullptr);
+
+    int size() const {return order.size();}
+    double getPadKm() const {return padKm;}
+
+    // Pairs whose shells overlap, and all pairs
+    long long candidateCount() const {return numCandidates;}
+    long long pairCount() const {return (long long)order.size() * (order.size() - 1) / 2;}
+
+    // The candidates are stored as one window per object: the object at sorted position k
+    // overlaps exactly those at sorted positions (k, windowEnd(k)). Consumers walk the
+    // windows instead of materializing what can be hundreds of millions of pairs.
+    int objectAt(int k) const {return order[k];}
+    int windowEnd(int k) const {return windowEnds[k];}
+
+    // Candidates of sorted positions [begin, end) as index pairs
+    void candidates(int begin, int end, vector<pair<int, int>>& pairs) const;
+
+    // Indices in at least one candidate pair, ascending; nothing else needs propagating
+    void involvedObjects(vector<int>& objects) const;
+
+    bool overlaps(int a, int b) const;
+
+    double lowKm(int i) const {return low[i];}
+    double highKm(int i) const {return high[i];}
+
+    private:
+    double padKm = 0.0;
+    long long numCandidates = 0;
+
+    // Shell of each input index
+    vector<double> low;
+    vector<double> high;
+
+    // Inputs sorted by low, and the end of each one's window
+    vector<int> order;
+    vector<int> windowEnds;
+};
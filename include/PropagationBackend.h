@@ -0,0 +1,110 @@
+/****************************************************************/
+/*                 PropagationBackend (Header)                  */
+/*                           Blake Owen                         */
+/*        Interface for propagating the whole catalog, with     */
+/*        the in-tree batch SGP4 and three Astro Standards      */
+/*        entry points behind it. TLEReader can time every      */
+/*        available backend and keep the fastest.               */
+/****************************************************************/
+
+#include <vector>
+
+#include "SatelliteCatalog.h"
+#include "Sgp4.h"
+#include "Sgp4Batch.h"
+#include "ThreadPool.h"
+#include "gl.h"
+
+#pragma once
+
+using namespace std;
+
+// Render slots per propagation chunk; a whole number of cache lines of (x, y, z) floats
+const int PROPAGATION_CHUNK_SLOTS = 4 * CACHE_LINE_BYTES / sizeof(GLfloat);
+
+// position() result for an entry the backend has no state for, such as an element set the
+// Astro Standards DLL did not load; like a pending object it is not drawn
+const int BACKEND_ERR_NO_KEY = -1;
+
+class PropagationBackend {
+    public:
+    virtual ~PropagationBackend() {}
+
+    virtual const char* name() const = 0;
+
+    // Propagate every catalog entry to ds50UTC and write (x, z, y) / kmPerUnit into points[slot * 3]
+    virtual void propagateAll(double ds50UTC, GLfloat* points, double kmPerUnit) = 0;
+
+    // TEME position (km) of one entry; returns 0 on success
+    virtual int position(const CatalogEntry& entry, double ds50UTC, double pos[3]) = 0;
+
+    // Catalog entries the backend skips because it has no state for them
+    virtual int missingCount() const {return 0;}
+};
+
+// In-tree SGP4: vectorized batch kernel, optionally spread over a worker pool
+class NativeBackend : public PropagationBackend {
+    vector<Sgp4Sat> sats;   // indexed by render slot
+    Sgp4Batch batch;
+    ThreadPool* pool;
+
+    public:
+    // sats[i] is the initialized state of the catalog entry in slot i; pool may be null
+    NativeBackend(const vector<Sgp4Sat>& sats, ThreadPool* pool);
+
+    const char* name() const {return "Native SGP4";}
+    void propagateAll(double ds50UTC, GLfloat* points, double kmPerUnit);
+    int position(const CatalogEntry& entry, double ds50UTC, double pos[3]);
+
+    // Switch one slot to a new element set; the batch is only rebuilt if its bucket changes
+    void replace(int slot, const Sgp4Sat& sat);
+    // Switch many slots at once; the batch is rebuilt at most once
+    void replace(const vector<int>& slots, const vector<Sgp4Sat>& sats);
+};
+
+// Astro Standards backends only propagate entries with a DLL key. When the native loader
+// also ran (benchmarking), sets the DLL rejected have key 0 and keep their zeroed point.
+
+// Astro Standards Sgp4PropDs50UTC: position, velocity, llh and mean elements per call
+class Ds50UtcBackend : public PropagationBackend {
+    vector<CatalogEntry> entries;   // those with a key
+    int numMissing;
+
+    public:
+    explicit Ds50UtcBackend(const SatelliteCatalog& catalog);
+
+    const char* name() const {return "Sgp4PropDs50UTC";}
+    void propagateAll(double ds50UTC, GLfloat* points, double kmPerUnit);
+    int position(const CatalogEntry& entry, double ds50UTC, double pos[3]);
+    int missingCount() const {return numMissing;}
+};
+
+// Astro Standards Sgp4PropDs50UtcPos: position only
+class Ds50UtcPosBackend : public PropagationBackend {
+    vector<CatalogEntry> entries;   // those with a key
+    int numMissing;
+
+    public:
+    explicit Ds50UtcPosBackend(const SatelliteCatalog& catalog);
+
+    const char* name() const {return "Sgp4PropDs50UtcPos";}
+    void propagateAll(double ds50UTC, GLfloat* points, double kmPerUnit);
+    int position(const CatalogEntry& entry, double ds50UTC, double pos[3]);
+    int missingCount() const {return numMissing;}
+};
+
+// Astro Standards Sgp4PropAllSats: one call for the whole catalog
+class AllSatsBackend : public PropagationBackend {
+    vector<__int64> keys;   // keyed entries only
+    vector<int> slots;      // render slot of keys[i]
+    vector<double> ephem;   // [i][6]: pos (km), vel (km/s)
+    int numMissing;
+
+    public:
+    explicit AllSatsBackend(const SatelliteCatalog& catalog);
+
+    const char* name() const {return "Sgp4PropAllSats";}
+    void propagateAll(double ds50UTC, GLfloat* points, double kmPerUnit);
+    int position(const CatalogEntry& entry, double ds50UTC, double pos[3]);
+    int missingCount() const {return numMissing;}
+};
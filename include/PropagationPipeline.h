@@ -0,0 +1,68 @@
+/****************************************************************/
+/*                 PropagationPipeline (Header)                 */
+/*                           Blake Owen                         */
+/*        Producer thread that propagates requested simulation  */
+/*        times into a back buffer and hands finished frames    */
+/*        to the render thread through a lock-free triple       */
+/*        buffer, so drawing never waits on propagation.        */
+/****************************************************************/
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "gl.h"
+
+#pragma once
+
+using namespace std;
+
+class PropagationPipeline {
+    public:
+    // Fill the buffer with positions for the given time (ds50 UTC)
+    typedef function<void(double, GLfloat*)> Producer;
+
+    ~PropagationPipeline();
+
+    // Allocate the three frames from an initial set of points and start the producer
+    void start(int numSats, const GLfloat* initial, Producer produce);
+    void stop();
+
+    // Ask for a frame at ds50UTC; only the most recent request is kept
+    void request(double ds50UTC);
+
+    // Newest finished frame if one was published since the last call, otherwise nullptr
+    const GLfloat* acquire(double* ds50UTC = nullptr);
+
+    // Run fn while the producer is guaranteed not to be propagating
+    void runExclusive(const function<void()>& fn);
+
+    // Wall time of the last produced frame
+    double lastProduceSeconds() const {return produceSeconds.load();}
+
+    private:
+    void producerLoop();
+
+    // The shared index carries a flag marking an unread frame
+    static const int INDEX_MASK = 3;
+    static const int FRESH = 4;
+
+    GLfloat* buffers[3] = {nullptr, nullptr, nullptr};
+    double times[3] = {0.0, 0.0, 0.0};
+    int back = 0;                  // producer only
+    int front = 2;                 // render thread only
+    atomic<int> middle;
+
+    Producer produce;
+    thread producer;
+    mutex requestLock;
+    condition_variable wake;
+    double requestedTime = 0.0;
+    bool hasRequest = false;
+    bool stopping = false;
+
+    mutex produceLock;
+    atomic<double> produceSeconds;
+};
@@ -0,0 +1,35 @@
+/****************************************************************/
+/*                  PropagatorContext (Header)                  */
+/*                           Blake Owen                         */
+/*        Reentrant handle on the initialized catalog. The      */
+/*        SGP4 records are immutable and shared; all scratch    */
+/*        state lives on the caller's stack, so any number of   */
+/*        threads can propagate through one context (or cheap  */
+/*        copies of it) at the same time without locking.       */
+/****************************************************************/
+
+#include <memory>
+#include <vector>
+
+#include "Sgp4.h"
+
+#pragma once
+
+using namespace std;
+
+class PropagatorContext {
+    shared_ptr<const vector<Sgp4Sat>> sats;   // indexed by render slot
+
+    public:
+    PropagatorContext() : sats(make_shared<const vector<Sgp4Sat>>()) {}
+    explicit PropagatorContext(shared_ptr<const vector<Sgp4Sat>> sats) : sats(sats) {}
+
+    int size() const {return sats->size();}
+    const Sgp4Sat& satellite(int slot) const {return (*sats)[slot];}
+
+    // TEME position (km) and velocity (km/s) of one object; returns an Sgp4Error code
+    int propagate(int slot, double ds50UTC, double pos[3], double vel[3]) const;
+
+    // Positions of slots [first, last) into xyz[(slot - first) * 3]; returns the number that failed
+    int propagateRange(int first, int last, double ds50UTC, double* xyz) const;
+};
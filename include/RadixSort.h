@@ -0,0 +1,23 @@
+/****************************************************************/
+/*                       RadixSort (Header)                     */
+/*                           Blake Owen                         */
+/*        LSD radix sort of 64-bit keys carrying an int         */
+/*        payload, for the spatial screeners. Byte passes       */
+/*        that every key agrees on are skipped.                 */
+/****************************************************************/
+
+#include <cstdint>
+#include <vector>
+
+#include "ThreadPool.h"
+
+#pragma once
+
+using namespace std;
+
+// Sort keys ascending and apply the same permutation to values; stable. With a pool each
+// pass histograms and scatters contiguous chunks in parallel.
+void radixSort(vector<uint64_t>& keys, vector<int>& values, ThreadPool* pool = nullptr);
+
+// Key that sorts in the same order as the double, negatives included
+uint64_t sortableKey(double value);
@@ -0,0 +1,65 @@
+/****************************************************************/
+/*                   SatelliteCatalog (Header)                  */
+/*                           Blake Owen                         */
+/*        Dense table of the active (de-duplicated) objects.    */
+/*        Each entry carries everything the hot paths need, so  */
+/*        propagation walks it linearly with no hashing and no  */
+/*        string parsing.                                       */
+/****************************************************************/
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "tle/DllUtils.h"
+#ifdef __cplusplus
+}
+#endif
+
+#pragma once
+
+using namespace std;
+
+// Use the newest element set of each object rather than the one nearest a chosen time
+const double SELECT_NEWEST_EPOCH = 0.0;
+
+// The selection rule for one object: whether a set with epoch candidate beats the one kept so
+// far. The newest wins, or the one nearest analysisTime with ties going to the newer epoch.
+// An identical epoch never wins, so of two sets for the same epoch the one seen first is kept;
+// a reload counts its files as seen before the sets already loaded.
+bool preferEpoch(double candidate, double current, double analysisTime);
+
+// Pick one element set per NORAD id from sets i = 0..n-1 with ids[i] and epochs[i] (ds50 UTC)
+// by preferEpoch, in index order. Returns the indices of the survivors, ordered by where each
+// object first appears, so slots stay load-ordered.
+vector<int> selectElementSets(const vector<int>& ids, const vector<double>& epochs, double analysisTime = SELECT_NEWEST_EPOCH);
+
+struct CatalogEntry {
+    __int64 satKey;   // Astro Standards satellite key (0 for the native propagator)
+    int source;       // index of the element set in load order
+    int noradId;      // parsed once at load
+    int slot;         // render slot in the point buffer
+};
+
+class SatelliteCatalog {
+    vector<CatalogEntry> entries;
+    unordered_set<int> loadedIds;   // only consulted while loading
+
+    public:
+    void clear();
+
+    // Append an object unless its NORAD id is already present; the first
+    // element set seen for an id wins. Slots are assigned densely in order.
+    bool add(__int64 satKey, int source, int noradId);
+
+    bool contains(int noradId) const {return loadedIds.find(noradId) != loadedIds.end();}
+    int size() const {return entries.size();}
+
+    const CatalogEntry& operator[](int i) const {return entries[i];}
+    vector<CatalogEntry>::const_iterator begin() const {return entries.begin();}
+    vector<CatalogEntry>::const_iterator end() const {return entries.end();}
+};
@@ -0,0 +1,118 @@
+/****************************************************************/
+/*                       Sgp4 (Header)                          */
+/*                           Blake Owen                         */
+/*        Native SGP4/SDP4 propagator following the public      */
+/*        Hoots/Roehrich (Spacetrack Report #3) and Vallado     */
+/*        (AIAA 2006-6753) formulation. Output is in the TEME   */
+/*        frame using the WGS-72 constants the Astro Standards  */
+/*        libraries default to.                                 */
+/****************************************************************/
+
+#pragma once
+
+// WGS-72 gravity model
+const double SGP4_MU            = 398600.8;          // km^3/s^2
+const double SGP4_RADIUS_KM     = 6378.135;          // km
+const double SGP4_J2            = 0.001082616;
+const double SGP4_J3            = -0.00000253881;
+const double SGP4_J4            = -0.00000165597;
+const double SGP4_J3OJ2         = SGP4_J3 / SGP4_J2;
+const double SGP4_XKE           = 0.07436691613317342;   // 60 / sqrt(R^3 / mu), er^1.5/min
+const double SGP4_TUMIN         = 1.0 / SGP4_XKE;
+const double SGP4_VKMPERSEC     = SGP4_RADIUS_KM * SGP4_XKE / 60.0;
+
+// Julian date of the ds50 origin (1950 Jan 0.0 UTC)
+const double SGP4_JD_DS50       = 2433281.5;
+
+// Error codes returned by sgp4Init / sgp4Propagate
+enum Sgp4Error {
+    SGP4_OK              = 0,
+    SGP4_ERR_ECCENTRICITY = 1,  // mean eccentricity out of range
+    SGP4_ERR_MEAN_MOTION  = 2,  // mean motion less than zero
+    SGP4_ERR_PERTURBED_E  = 3,  // perturbed eccentricity out of range
+    SGP4_ERR_SEMILATUS    = 4,  // semi-latus rectum less than zero
+    SGP4_ERR_DECAYED      = 6,  // satellite has decayed
+    SGP4_ERR_PENDING      = 7   // placeholder from sgp4MarkPending, not initialized yet
+};
+
+// Mean elements as read from a two-line element set, in SGP4 units
+struct TleElements {
+    int satNum;
+    double epochDs50UTC;  // days since 1950 Jan 0.0 UTC
+    double bstar;         // 1/earth radii
+    double ndot;          // rad/min^2
+    double nddot;         // rad/min^3
+    double incl;          // rad
+    double raan;          // rad
+    double ecc;
+    double argp;          // rad
+    double mo;            // rad
+    double no;            // Kozai mean motion, rad/min
+};
+
+// Initialized SGP4 state for a single satellite. Propagation never
+// modifies this record, so one instance can be shared between threads.
+struct Sgp4Sat {
+    int satNum;
+    double epochDs50UTC;
+
+    // Near-earth
+    int isimp;
+    char method;          // 'n' near-earth, 'd' deep-space, 'p' pending
+    double aycof, con41, cc1, cc4, cc5, d2, d3, d4, delmo, eta, argpdot, omgcof,
+           sinmao, t2cof, t3cof, t4cof, t5cof, x1mth2, x7thm1, mdot, nodedot,
+           xlcof, xmcof, nodecf;
+
+    // Deep-space
+    int irez;
+    double d2201, d2211, d3210, d3222, d4410, d4422, d5220, d5232, d5421, d5433,
+           dedt, del1, del2, del3, didt, dmdt, dnodt, domdt, e3, ee2, peo, pgho,
+           pho, pinco, plo, se2, se3, sgh2, sgh3, sgh4, sh2, sh3, si2, si3, sl2,
+           sl3, sl4, gsto, xfact, xgh2, xgh3, xgh4, xh2, xh3, xi2, xi3, xl2, xl3,
+           xl4, xlamo, zmol, zmos;
+
+    // Mean elements at epoch
+    double bstar, inclo, nodeo, ecco, argpo, mo, noUnkozai;
+    double a, altp, alta;
+};
+
+// Parse a two-line element set. Returns false when a field is malformed.
+bool parseTleLines(const char* line1, const char* line2, TleElements& el);
+
+// Same, for lines that are not NUL-terminated (e.g. inside a memory-mapped file);
+// len1 and len2 exclude the line terminator
+bool parseTleLines(const char* line1, int len1, const char* line2, int len2, TleElements& el);
+
+// Modulo-10 checksum in column 69: digits count their value, '-' counts one.
+// Lines too short to carry a checksum pass.
+bool tleChecksumValid(const char* line, int len);
+
+// Fill the mean elements (everything but satNum and epoch) from the units used by TLE and
+// OMM: rev/day, rev/day^2 and rev/day^3 as written in the message, degrees, 1/earth radii
+void elementsFromTleUnits(double no, double ndot, double nddot, double bstar, double incl,
+                          double raan, double ecc, double argp, double mo, TleElements& el);
+
+// Days since 1950 Jan 0.0 UTC of a calendar date
+double calendarToDs50(int year, int mon, int day, int hr, int minute, double sec);
+
+// Five-column catalog number: digits, or Alpha-5 above 99999 (A = 10, skipping I and O)
+bool parseCatalogNumber(const char* field, int& satNum);
+
+// Mean perigee and apogee altitudes (km above the WGS-72 radius) without initializing
+void meanAltitudes(const TleElements& el, double& perigeeKm, double& apogeeKm);
+
+// Initialize the SGP4 state for a set of mean elements.
+int sgp4Init(const TleElements& el, Sgp4Sat& sat);
+
+// Stand-in for an object whose initialization is still queued: carries the id, epoch and
+// orbit size, and sgp4Propagate returns SGP4_ERR_PENDING for it
+void sgp4MarkPending(const TleElements& el, Sgp4Sat& sat);
+inline bool sgp4IsPending(const Sgp4Sat& sat) {return sat.method == 'p';}
+
+// Propagate to tsince minutes from epoch. Position in km, velocity in km/s (TEME).
+int sgp4Propagate(const Sgp4Sat& sat, double tsince, double r[3], double v[3]);
+
+// Propagate to an absolute time in days since 1950 (UTC).
+inline int sgp4PropagateDs50(const Sgp4Sat& sat, double ds50UTC, double r[3], double v[3]) {
+    return sgp4Propagate(sat, (ds50UTC - sat.epochDs50UTC) * 1440.0, r, v);
+}
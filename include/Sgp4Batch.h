@@ -0,0 +1,78 @@
+/****************************************************************/
+/*                     Sgp4Batch (Header)                       */
+/*                           Blake Owen                         */
+/*        Structure-of-arrays batch propagator. Near-earth      */
+/*        satellites are evaluated SGP4_BATCH_LANES at a time   */
+/*        with branch-free math so the lane loops vectorize;    */
+/*        deep-space satellites are bucketed separately and     */
+/*        run through the scalar propagator.                    */
+/****************************************************************/
+
+#include <vector>
+
+#include "Sgp4.h"
+#include "gl.h"
+
+#pragma once
+
+using namespace std;
+
+// Lanes per block: one AVX-512 register of doubles, otherwise two AVX2/NEON registers
+#if defined(__AVX512F__)
+#define SGP4_BATCH_LANES 8
+#else
+#define SGP4_BATCH_LANES 4
+#endif
+
+class Sgp4Batch {
+    public:
+    // Build the batch from initialized satellites; slots[i] is the render slot of sats[i].
+    // With chunkSlots > 0 the work is split into chunks that each own the render slots
+    // [c * chunkSlots, (c + 1) * chunkSlots), so chunks can run on different threads.
+    void build(const vector<Sgp4Sat>& sats, const vector<int>& slots, int chunkSlots = 0);
+
+    // Propagate every satellite to ds50UTC and write (x, z, y) / kmPerUnit into points[slot * 3]
+    void propagate(double ds50UTC, GLfloat* points, double kmPerUnit) const;
+
+    // Propagate only the satellites of chunk c
+    void propagateChunk(int c, double ds50UTC, GLfloat* points, double kmPerUnit) const;
+
+    int chunkCount() const {return numChunks;}
+
+    // Swap in a new element set for one render slot without rebuilding. Fails (and changes
+    // nothing) when the satellite moves between the near-earth and deep-space buckets, or
+    // into or out of the pending state.
+    bool replace(int slot, const Sgp4Sat& sat);
+
+    int nearEarthBlocks() const {return numBlocks;}
+    int nearEarthCount() const {return numNearEarth;}
+    int deepSpaceCount() const {return deepSats.size();}
+
+    private:
+    void propagateBlock(int b, double ds50UTC, GLfloat* points, double kmPerUnit) const;
+    void fillLane(int k, const Sgp4Sat& s);
+
+    int numBlocks = 0;
+    int numNearEarth = 0;
+    int numChunks = 0;
+
+    // Chunk c covers blocks [chunkBlocks[c], chunkBlocks[c + 1]) and deep-space
+    // entries [chunkDeep[c], chunkDeep[c + 1])
+    vector<int> chunkBlocks;
+    vector<int> chunkDeep;
+
+    // Near-earth bucket, each chunk padded to a multiple of SGP4_BATCH_LANES (padding lanes have slot -1)
+    vector<int> slot;
+    vector<double> epoch, mo, mdot, argpo, argpdot, nodeo, nodedot, nodecf;
+    vector<double> cc1, bcc4, bcc5, t2cof, t3cof, t4cof, t5cof, d2, d3, d4;
+    vector<double> omgcof, xmcof, eta, delmo, sinmao;
+    vector<double> noUnkozai, aoFactor, ecco, inclo, sinio, cosio;
+    vector<double> aycof, xlcof, con41, x1mth2, x7thm1;
+
+    // Deep-space bucket
+    vector<Sgp4Sat> deepSats;
+    vector<int> deepSlots;
+
+    // Render slot -> near-earth lane k, or deep-space entry -1 - d
+    vector<int> laneOfSlot;
+};
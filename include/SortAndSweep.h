@@ -0,0 +1,53 @@
+/****************************************************************/
+/*                     SortAndSweep (Header)                    */
+/*                           Blake Owen                         */
+/*        Sweep-and-prune screening: objects are radix-sorted   */
+/*        along the axis of greatest variance, and each one is  */
+/*        tested against the window of objects that follow it  */
+/*        within tolerance along that axis.                     */
+/****************************************************************/
+
+#include <vector>
+
+#include "SpaceDebris.h"
+#include "ThreadPool.h"
+
+#pragma once
+
+using namespace std;
+
+// Objects per lane block of the window test; the loop over a block is written to vectorize
+const int SWEEP_LANES = 8;
+
+class SortAndSweep {
+
+public:
+
+    SortAndSweep(const vector<SpaceDebris>& debris_list, double tolerance, ThreadPool* pool = nullptr);
+
+    // Every distinct pair no further apart than tolerance (indices into the debris list)
+    void find_pairs(vector<DebrisPair>& pairs) const;
+
+    // One entry per object in a pair, with its closest partner
+    void find_risky_debris(vector<SpaceDebris>& riskList) const;
+
+    // 0, 1 or 2 for x, y or z
+    int sweepAxis() const {return axis;}
+
+private:
+
+    vector<SpaceDebris> debris_list;
+
+    double tolerance;
+
+    ThreadPool* pool;
+
+    int axis;
+
+    // Objects in sweep order: the sweep axis first, then the other two, followed by
+    // SWEEP_LANES sentinels whose sweep coordinate is infinite so blocks never run off the end
+    vector<int> order;
+    vector<double> sweep, other1, other2;
+
+    void sweep_range(int begin, int end, vector<DebrisPair>& pairs) const;
+};
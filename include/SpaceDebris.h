@@ -23,37 +23,33 @@ struct SpaceDebris {
     }
 };
 
-struct OctNode {
+// Two entries of a debris list (by index) within the screening tolerance of each other
+struct DebrisPair {
 
-    OctNode* children[8] = {nullptr};
+    int first;
 
-    vector<SpaceDebris> idList;
+    int second;
 
-    //SpaceDebris debrisObject;
+    double distance;
 };
 
-class Octree {
-
-public:
-
-    Octree(vector<SpaceDebris>& debris_list, double tolerance);
-
-    void find_risky_debris(vector<SpaceDebris>& riskList);
-
-private:
-
-    OctNode* root;
+//vector<SpaceDebris> find_local_optimum(const SpaceDebris& start, const vector<SpaceDebris>& debris_list, double tolerance);
 
-    vector<SpaceDebris> debris_list;
+vector<SpaceDebris> find_local_optimum(vector<SpaceDebris>& debris_list, double tolerance, int powerIterations);
 
-    void insert(OctNode* node, SpaceDebris& debris, double x_min, double x_max, double y_min, double y_max, double z_min, double z_max, double& tolerance);
-    
-    void find_risky(OctNode* node, vector<SpaceDebris>& riskList);
-};
+// Entries at exactly the same position are one object loaded twice (e.g. under two ids),
+// not a conjunction; every screener skips them
+inline bool is_same_object(double dist2) {
+    return dist2 == 0.0;
+}
 
-//vector<SpaceDebris> find_local_optimum(const SpaceDebris& start, const vector<SpaceDebris>& debris_list, double tolerance);
+// Squared distance of a pair the screeners report at squared tolerance tolerance2
+inline bool is_risky_pair(double dist2, double tolerance2) {
+    return dist2 <= tolerance2 && !is_same_object(dist2);
+}
 
-vector<SpaceDebris> find_local_optimum(vector<SpaceDebris>& debris_list, double tolerance, int powerIterations);
+// Append one risk entry per object that appears in a pair, pointing at its closest partner
+void risk_list_from_pairs(const vector<SpaceDebris>& debris_list, const vector<DebrisPair>& pairs, vector<SpaceDebris>& riskList);
 
 bool compareDebrisDistanceLess(SpaceDebris d1, SpaceDebris d2);
 bool compareDebrisDistanceGreater(SpaceDebris d1, SpaceDebris d2);
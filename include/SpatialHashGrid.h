@@ -0,0 +1,66 @@
+/****************************************************************/
+/*                   SpatialHashGrid (Header)                   */
+/*                           Blake Owen                         */
+/*        Uniform grid of tolerance-wide cells stored in a      */
+/*        flat open-addressing hash table, so only occupied     */
+/*        cells cost memory. Each object is checked against     */
+/*        its own and the 26 surrounding cells.                 */
+/****************************************************************/
+
+#include <cstdint>
+#include <vector>
+
+#include "SpaceDebris.h"
+
+#pragma once
+
+using namespace std;
+
+class SpatialHashGrid {
+
+public:
+
+    SpatialHashGrid(const vector<SpaceDebris>& debris_list, double tolerance);
+
+    // Every distinct pair no further apart than tolerance (indices into the debris list)
+    void find_pairs(vector<DebrisPair>& pairs) const;
+
+    // One entry per object in a pair, with its closest partner
+    void find_risky_debris(vector<SpaceDebris>& riskList) const;
+
+    int cellCount() const {return numCells;}
+
+private:
+
+    // One table slot per occupied cell; objects of a cell are contiguous from start. Slots
+    // and objects are each one record so a random access touches a single cache line.
+    struct Cell {
+        uint64_t key;
+        int start;
+        int count;
+    };
+
+    struct Point {
+        double x, y, z;
+        int index;
+    };
+
+    vector<SpaceDebris> debris_list;
+
+    double tolerance;
+
+    // Cell width; the tolerance unless the catalog spans more than 2^21 cells per axis
+    double cellSize;
+
+    // Power-of-two table, at most half full
+    vector<Cell> table;
+    int shift;
+    int numCells;
+
+    // Objects grouped by cell
+    vector<Point> points;
+
+    int find_slot(uint64_t key) const;
+
+    void compare_cells(const Cell& a, const Cell& b, bool same, vector<DebrisPair>& pairs) const;
+};
@@ -0,0 +1,82 @@
+/****************************************************************/
+/*                    StartupProfiler (Header)                  */
+/*                           Blake Owen                         */
+/*        Wall time, CPU time, object counts and peak RSS of    */
+/*        each startup phase, printed as a table and            */
+/*        optionally written as JSON to track regressions.      */
+/****************************************************************/
+
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#pragma once
+
+using namespace std;
+
+class StartupProfiler {
+    public:
+    StartupProfiler();
+
+    // Times one phase from construction to destruction; phases nest per thread and may run
+    // on any thread. A null profiler makes it a no-op.
+    class Phase {
+        public:
+        Phase(StartupProfiler* profiler, const char* name);
+        ~Phase();
+
+        Phase(const Phase&) = delete;
+        Phase& operator=(const Phase&) = delete;
+
+        // Objects, files or sets the phase handled; shown in the count column
+        void setCount(long long count) {this->count = count;}
+        // End the phase before the scope does
+        void stop();
+
+        private:
+        StartupProfiler* profiler;
+        int index;
+        long long count = -1;
+    };
+
+    // Write the phases as JSON to this file when finish() runs; empty to skip
+    void setJsonFile(const string& fileName) {jsonFile = fileName;}
+
+    // Print the table, and write the JSON file, once; later calls do nothing
+    void finish();
+
+    void printTable(ostream& out);
+    bool writeJson(const string& fileName);
+
+    private:
+    struct Record {
+        string name;
+        int depth;
+        bool background;          // ran on a thread other than the one that built the profiler
+        double startMs;           // from profiler construction
+        double wallMs;
+        double cpuMs;             // whole process, so worker threads count
+        long long count;
+        double peakRssMb;         // process high-water mark when the phase ended
+        bool done;
+    };
+
+    int begin(const char* name);
+    void end(int index, long long count);
+
+    chrono::steady_clock::time_point created;
+    thread::id ownerThread;
+    double cpuStartMs;
+    mutex lock;
+    vector<Record> records;
+    vector<double> cpuAtStart;
+    string jsonFile;
+    bool finished = false;
+};
+
+// Process CPU time (user + system, every thread) and peak resident set size
+double processCpuMs();
+double peakRssMb();
@@ -1,16 +1,34 @@
 /****************************************************************/
 /*                       TLEReader (Header)                     */
 /*                           Blake Owen                         */
-/*        This implementation uses the US SpaceForce publicly   */
-/*        released SGP4 propagation libraries for reading and   */
-/*        propagating TLE debris and satellite objects.         */
+/*        This implementation uses the in-tree SGP4 propagator  */
+/*        (Sgp4.h) or the US SpaceForce publicly released SGP4  */
+/*        propagation libraries for reading and propagating     */
+/*        TLE debris and satellite objects.                     */
 /****************************************************************/
 
 #include "SpaceDebris.h"
+#include "Sgp4.h"
+#include "ThreadPool.h"
+#include "SatelliteCatalog.h"
+#include "PropagationBackend.h"
+#include "EphemerisTable.h"
+#include "AdaptiveScheduler.h"
+#include "PropagatorContext.h"
+#include "CatalogSnapshot.h"
+#include "TleHistory.h"
+#include "FileWatcher.h"
+#include "CatalogFilter.h"
+#include "StartupProfiler.h"
+#include <atomic>
 #include "gl.h"
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
-#include <unordered_set>
 
 using namespace std;
 
@@ -44,29 +62,205 @@ struct Datetime {
     int seconds;
 };
 
+// Element sets from files that changed while running, or objects the init thread has set up,
+// staged off the propagating thread and published by it between frames
+struct CatalogReload {
+    unique_ptr<TleHistory> history;   // every set including the new ones; null without history
+    vector<int> slots;                // objects the new files mention, or that were initialized
+    vector<TleElements> elements;     // set each slot was prepared for
+    vector<Sgp4Sat> sats;             // elements[i] initialized off the propagating thread
+    bool fromFiles = false;           // staged by the file watcher
+    bool initDone = false;            // holds the last batch of the initial catalog
+};
+
+// Element set that could not be initialized; reported instead of aborting the load
+struct QuarantinedSet {
+    int satNum;
+    double epochDs50UTC;
+    string reason;
+};
+
 class TLEReader {
     vector<__int64> satKeys;
+    // Initialized native records: owned after a text parse, or read from the mapped snapshot;
+    // createBackends() copies them into activeSats and activeElements
+    vector<Sgp4Sat> nativeSats;
+    CatalogSnapshot snapshot;
+    const Sgp4Sat* nativeRecords = nullptr;
+    vector<TleElements> nativeElements;
+    const TleElements* nativeElementRecords = nullptr;
+    bool useSnapshot = true;
+    double analysisTime = SELECT_NEWEST_EPOCH;
+    unique_ptr<ThreadPool> pool;
+    bool useNativeSgp4 = true;
+    bool useParallel = true;
+    bool benchmarkBackends = false;
+
+    // Available backends, the one in use and their benchmark timings (ms per catalog pass)
+    vector<unique_ptr<PropagationBackend>> backends;
+    vector<double> backendMs;
+    int backendIndex = 0;
+
+    // Adaptive per-object update rates (native SGP4 only); settings may come from another thread
+    unique_ptr<AdaptiveScheduler> adaptive;
+    atomic<bool> useAdaptive{false};
+    atomic<double> simSecondsPerFrame{1.0 / 60.0};
+    atomic<double> adaptiveToleranceKm{0.5};
+    atomic<int> propagatedCount{0};
     const double earthRadiusKm = 6371.0;
-    unordered_set<int> uniqueSats;
-    unordered_set<int> addedSet;
-
-    double 
-    pos[3],           //Position (km)
-    vel[3],           //Velocity (km/s)
-    llh[3],           //Latitude(deg), Longitude(deg), Height above Geoid (km)
-    meanKep[6],       //Mean Keplerian elements
-    oscKep[6],        //Osculating Keplerian elements
-    nodalApPer[3],    //Nodal period, apogee, perigee
-    epochDs50UTC,
-    mse,
-    ds50UTC;
-
-    char  valueStr[GETSETSTRLEN];
+    SatelliteCatalog catalog;
+
+    // Every parsed element set per object; native propagation follows the set nearest the
+    // simulation time. activeSats holds the current set of every slot.
+    TleHistory history;
+    bool useHistory = true;
+    vector<Sgp4Sat> activeSats;
+    vector<TleElements> activeElements;
+    NativeBackend* nativeBackend = nullptr;
+
+    // Shared, immutable native state for reentrant propagation; rebuilt on demand after switches
+    PropagatorContext context;
+    mutex contextLock;
+    bool contextStale = false;
+
+    // TLE/3LE or CCSDS OMM files, directories or patterns to load; the bundled daily files when empty
+    vector<string> sources;
+
+    // Element sets the parsers drop before they reach the catalog
+    CatalogFilter filter;
+    atomic<int> numFiltered{0};
+
+    // Hot reload: the watcher thread owns the reload* state; pending is handed over under reloadLock
+    FileWatcher watcher;
+    unordered_map<int, int> reloadSlots;     // NORAD id -> render slot
+    vector<TleElements> reloadElements;      // set each slot will be on once pending is published (no history)
+    vector<TleElements> reloadSets;          // every set seen, newest files first (history)
+    atomic<double> reloadTime{0.0};          // latest simulation time handed to updateHistory
+    mutex reloadLock;
+    CatalogReload pending;
+    atomic<bool> reloadPending{false};
+
+    // Lazy initialization: objects start out pending and the init thread publishes them in
+    // batches through the reload path, so the window opens before SGP4 setup is done
+    bool lazyInit = true;
+    thread initThread;
+    atomic<bool> stopInit{false};
+    atomic<bool> initializing{false};
+    atomic<int> numPending{0};
+    vector<TleElements> initSets;   // every parsed set, kept for the snapshot written at the end
+    uint64_t initFingerprint = 0;
+    mutex quarantineLock;
+    vector<QuarantinedSet> quarantine;
+
+    // Load phases are timed into this when set; the background init phase may end after ReadFiles
+    StartupProfiler* profiler = nullptr;
+
+    const vector<string>& sourceList() const;
+    size_t readTleFile(const char* fileName, vector<TleElements>& elements, ThreadPool* workers);
+    void readTleFiles(const vector<const char*>& files, vector<TleElements>& elements);
+    int loadNative(const vector<const char*>& files, double& epoch);
+    int loadAstroStandards(const vector<const char*>& files, double& epoch);
+    int getSatNum(int i);
+    int getKeySatNum(__int64 satKey);
+    void createBackends(bool astroStandards);
+    void timeBackends(double time);
+    void reloadFiles(const vector<string>& files);
+    void stageReload(CatalogReload& reload);
+    int publishReload(double time, vector<int>& switchedSlots, vector<Sgp4Sat>& switchedSats);
+    void replaceSlots(const vector<int>& slots, const vector<TleElements>& els, const vector<Sgp4Sat>& sats);
+    void initializeSets(const TleElements* elements, Sgp4Sat* sats, int* errors, int count);
+    void initializeCatalog();
+    void quarantineSet(int satNum, double epochDs50UTC, const string& reason);
+    void reportQuarantine();
 
     public:
+    ~TLEReader();
+
+    // Load a TLE/3LE or OMM file, every file in a directory, or a pattern such as "archive/2023_*.txt".
+    // The first call replaces the bundled default files.
+    void addSource(const string& pathOrPattern) {sources.push_back(pathOrPattern);}
+    // Load only the element sets an expression such as "perigee<2000 incl=50..60" accepts (see
+    // CatalogFilter). Ages count from the analysis time, or from the start of the UTC day.
+    bool setFilter(const string& expression, string& error) {return filter.parse(expression, error);}
+    const CatalogFilter& getFilter() {return filter;}
+    int getFilteredCount() {return numFiltered.load();}
+    // Re-read source files as they are written or replaced (native SGP4 only). Objects whose
+    // element set changed are initialized in the background and switched over by the next
+    // updateHistory() call, so every frame sees either the old or the new catalog.
+    bool startWatching();
+    void stopWatching() {watcher.stop();}
+    // Initialize the native catalog on the worker pool after ReadFiles returns instead of before
+    // (not while benchmarking backends). Objects stay pending, and are not drawn, until
+    // updateHistory() publishes their batch.
+    void setLazyInit(bool lazy) {lazyInit = lazy;}
+    bool isInitializing() {return initializing.load();}
+    int getPendingCount() {return numPending.load();}
+    // Reloaded or newly initialized objects are waiting for the next updateHistory() call
+    bool hasStagedUpdates() {return reloadPending.load();}
+    // Element sets that failed to initialize: dropped from the catalog, or left pending when
+    // found by the init thread. Also written to quarantine.txt.
+    vector<QuarantinedSet> getQuarantine();
+    int getQuarantinedCount();
+    // Record DLL loading, parsing, initialization and the initial propagate as startup phases
+    void setProfiler(StartupProfiler* startupProfiler) {profiler = startupProfiler;}
+    // Native SGP4 is the default; the Astro Standards DLLs are only loaded when disabled or benchmarking
+    void setUseNativeSgp4(bool native) {useNativeSgp4 = native;}
+    bool isNativeSgp4() {return useNativeSgp4;}
+    // Start from the binary catalog snapshot when it matches the TLE files, and write one when it does not
+    void setUseSnapshot(bool enabled) {useSnapshot = enabled;}
+    // Keep the element set nearest this time (ds50 UTC) for each object instead of the newest
+    void setAnalysisTime(double ds50UTC) {analysisTime = ds50UTC;}
+    // Keep every element set and switch each object to the one nearest the simulation time
+    void setTleHistory(bool enabled) {useHistory = enabled;}
+    // Load every backend at startup, time each on the catalog and keep the fastest
+    void setBenchmarkBackends(bool benchmark) {benchmarkBackends = benchmark;}
+    int getBackendCount() {return backends.size();}
+    const char* getBackendName(int i) {return backends.at(i)->name();}
+    double getBackendMs(int i) {return i < (int)backendMs.size() ? backendMs[i] : -1.0;}
+    int getBackendIndex() {return backendIndex;}
+    // Not thread-safe with propagate(); callers on other threads must serialize
+    void selectBackend(int i) {backendIndex = i;}
+    PropagationBackend* getBackend() {return backends.empty() ? nullptr : backends[backendIndex].get();}
+    // Propagate only objects whose update interval has elapsed and extrapolate the rest
+    void setAdaptiveUpdates(bool enabled) {useAdaptive.store(enabled);}
+    bool isAdaptiveUpdates() {return useAdaptive.load();}
+    void setSimSecondsPerFrame(double seconds) {simSecondsPerFrame.store(seconds);}
+    // Largest extrapolation error adaptive updates allow (km); applied by the next propagate()
+    void setAdaptiveToleranceKm(double km) {adaptiveToleranceKm.store(km);}
+    // Objects the adaptive scheduler still propagates on every frame
+    int getEveryFrameCount() {return adaptive != nullptr ? adaptive->everyFrameCount() : 0;}
+    // Objects run through SGP4 by the last propagate() call; pending objects are not counted
+    int getPropagatedCount() {return propagatedCount.load();}
+    // Spread per-frame propagation over a persistent worker pool (native SGP4 only)
+    void setParallelPropagation(bool parallel) {useParallel = parallel;}
+    bool isParallelPropagation() {return useParallel;}
+    // Worker pool propagation runs on, or null; safe to share since run() serializes callers
+    ThreadPool* getThreadPool() {return pool.get();}
+    // Point buffers are cache-line aligned so propagation chunks never share a line
+    static GLfloat* allocatePoints(int numSats);
+    static void freePoints(GLfloat* points);
     __int64 getKey(int i) {return satKeys.at(i);}
-    bool isAdded(int id) {return (addedSet.find(id) != addedSet.end());}
+    bool isAdded(int id) {return catalog.contains(id);}
+    const SatelliteCatalog& getCatalog() {return catalog;}
+    // Initialized native state of every catalog entry and its render slot
+    void getNativeCatalog(vector<Sgp4Sat>& sats, vector<int>& slots);
+    // Mean elements of every catalog entry, indexed by render slot; safe alongside propagate()
+    void getCatalogElements(vector<TleElements>& elements);
+    double getKmPerUnit() {return earthRadiusKm;}
+    // Reentrant native propagator over the catalog (slot order); safe to use from any
+    // number of threads, including alongside propagate(). Holds the sets current when taken.
+    PropagatorContext getContext();
+    // Publish reloaded element sets and switch objects to their set nearest time (native SGP4
+    // only). Appends the slots that changed and their new initialized sets, which callers pass
+    // on to anything keeping its own copy of the catalog. Call before propagate().
+    int updateHistory(double time, vector<int>& switchedSlots, vector<Sgp4Sat>& switchedSats);
+    // Positions of the given render slots (row i = slots[i]) at numSteps timesteps from start.
+    // Native SGP4 works from a context and the DLL path takes the Astro Standards lock, so
+    // it may run alongside propagate().
+    void generateEphemeris(EphemerisTable& table, const vector<int>& slots, double start, double stepMinutes,
+                           int numSteps, EphemerisLayout layout);
     GLfloat* ReadFiles(int& numSats, double& epoch, vector<SpaceDebris>& debris);
+    // Positions of every catalog entry from the sets published by the last updateHistory() call
     void propagate(double time, GLfloat* points, int numSats, bool setDebris, vector<SpaceDebris>& debris);
 };
 
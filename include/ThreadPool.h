@@ -0,0 +1,56 @@
+/****************************************************************/
+/*                     ThreadPool (Header)                      */
+/*                           Blake Owen                         */
+/*        Persistent worker threads for data-parallel loops.    */
+/*        Workers sleep between jobs and pull task indices      */
+/*        from a shared counter; the calling thread helps and   */
+/*        returns once every task has finished.                 */
+/****************************************************************/
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#pragma once
+
+using namespace std;
+
+// Destructive interference size assumed for chunking shared output buffers
+const int CACHE_LINE_BYTES = 64;
+
+class ThreadPool {
+    public:
+    // numThreads counts the calling thread; 0 uses every hardware thread
+    explicit ThreadPool(int numThreads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Run task(i) for every i in [0, numTasks). Safe to call from several threads: while
+    // the workers are busy with another caller's job, tasks run serially on the caller.
+    void run(int numTasks, const function<void(int)>& task);
+
+    int size() const {return workers.size() + 1;}
+
+    private:
+    void workerLoop();
+    void drain();
+
+    vector<thread> workers;
+
+    mutex lock;
+    mutex runLock;     // held by the caller that owns the workers
+    condition_variable wake;
+    condition_variable finished;
+
+    const function<void(int)>* job = nullptr;
+    int jobTasks = 0;
+    atomic<int> nextTask;
+    int activeWorkers = 0;
+    unsigned long long generation = 0;
+    bool stopping = false;
+};
@@ -0,0 +1,62 @@
+/****************************************************************/
+/*                      TleHistory (Header)                     */
+/*                           Blake Owen                         */
+/*        Every loaded element set of every object, sorted by   */
+/*        epoch. Each render slot follows the set nearest the   */
+/*        simulation time; switch points (midpoints between     */
+/*        consecutive epochs) are kept in one sorted list so    */
+/*        playback only visits the objects whose set changes.   */
+/****************************************************************/
+
+#include <utility>
+#include <vector>
+
+#include "Sgp4.h"
+
+#pragma once
+
+using namespace std;
+
+class TleHistory {
+    public:
+    // Every element set of every object, in any order; objects are matched by satNum.
+    // Repeats of the same epoch (overlapping files) are kept once.
+    void build(const TleElements* elements, int count);
+
+    // Objects in render-slot order: slotIds[slot] is the NORAD id drawn in slot. Each slot
+    // starts on the set selectElementSets would pick for analysisTime.
+    void bind(const vector<int>& slotIds, double analysisTime);
+
+    int size() const {return sets.size();}
+    int slotCount() const {return currentSet.size();}
+    int setCount(int slot) const {return slotEnd[slot] - slotBegin[slot];}
+
+    // True when some object has more than one set, i.e. update() can ever switch anything
+    bool hasSwitches() const {return !switches.empty();}
+
+    // Index of slot's set nearest ds50UTC (ties go to the newer set); O(log k) in its k sets
+    int nearest(int slot, double ds50UTC) const;
+
+    int current(int slot) const {return currentSet[slot];}
+    const TleElements& at(int index) const {return sets[index];}
+
+    // Move every slot to its set nearest ds50UTC and append the slots that changed to
+    // switched. Only the switch points between the previous and this time are visited,
+    // so a playback frame costs O(log n + switches); a jump re-checks every slot.
+    int update(double ds50UTC, vector<int>& switched);
+
+    private:
+    bool recheck(int slot, double ds50UTC, vector<int>& switched);
+
+    vector<TleElements> sets;     // grouped by object, ascending epoch within an object
+    vector<double> epochs;        // sets[i].epochDs50UTC, contiguous for the searches
+    vector<int> slotBegin;        // slot's sets are [slotBegin, slotEnd); empty if unknown
+    vector<int> slotEnd;
+    vector<int> currentSet;
+
+    // (time, slot) where slot moves to its next set; sorted by time
+    vector<pair<double, int>> switches;
+    int cursor = -1;              // switches at or before the last update time; -1 before the first
+    vector<unsigned> visited;     // per slot, stamp of the last update that re-checked it
+    unsigned stamp = 0;
+};
@@ -0,0 +1,38 @@
+/****************************************************************/
+/*                      TleParser (Header)                      */
+/*                           Blake Owen                         */
+/*        Parallel parser for TLE/3LE text already in memory    */
+/*        (usually a MappedFile). The buffer is split into      */
+/*        chunks on line boundaries and each chunk parses its   */
+/*        own element sets in place, straight into the output   */
+/*        array, with no per-line copies.                       */
+/****************************************************************/
+
+#include <cstddef>
+#include <vector>
+
+#include "CatalogFilter.h"
+#include "Sgp4.h"
+#include "ThreadPool.h"
+
+#pragma once
+
+using namespace std;
+
+struct TleParseStats {
+    int sets = 0;          // element sets appended
+    int malformed = 0;     // rejected: a field failed to parse
+    int badChecksum = 0;   // rejected: column 69 checksum mismatch
+    int filtered = 0;      // valid, but not accepted by the filter
+
+    // Line 1 of the first rejected set in the buffer, not NUL-terminated
+    const char* firstError = nullptr;
+    int firstErrorLength = 0;
+};
+
+// Parse every element set in [data, data + size) and append them to elements in file order.
+// A set is a line starting with '1' directly followed by a line starting with '2'; name
+// lines and blank lines are skipped. With a pool the chunks are parsed in parallel and the
+// result is identical to the serial one. With a filter, only the sets it accepts are kept.
+TleParseStats parseTleBuffer(const char* data, size_t size, vector<TleElements>& elements, ThreadPool* pool,
+                             const CatalogFilter* filter = nullptr);
@@ -0,0 +1,35 @@
+/****************************************************************/
+/*                    WindowScreener (Header)                   */
+/*                           Blake Owen                         */
+/*        Closest sampled approach of every altitude-shell      */
+/*        candidate pair across an ephemeris table, for         */
+/*        screening a time window rather than one instant.      */
+/****************************************************************/
+
+#include <atomic>
+#include <vector>
+
+#include "EphemerisTable.h"
+#include "OrbitShellFilter.h"
+#include "SpaceDebris.h"
+#include "ThreadPool.h"
+
+#pragma once
+
+using namespace std;
+
+// Closest sampled approach of one pair
+struct Conjunction {
+    int first;          // shell filter indices (render slots)
+    int second;
+    double missKm;
+    int step;           // timestep of the closest sample
+};
+
+// Screen the shell candidates over every timestep of the table, keeping pairs that come
+// within toleranceKm, closest first. Row r of the table holds filter index rows[r]; it only
+// needs the filter's involvedObjects(). Stops early, with no results, once cancel is set.
+// Sat-major tables keep each track contiguous and screen fastest.
+void screenWindow(const EphemerisTable& table, const vector<int>& rows, const OrbitShellFilter& shells,
+                  double toleranceKm, vector<Conjunction>& conjunctions, ThreadPool* pool = nullptr,
+                  const atomic<bool>* cancel = nullptr);
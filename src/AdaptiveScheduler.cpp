@@ -0,0 +1,146 @@
+/****************************************************************/
+/*                       AdaptiveScheduler                      */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        Between updates an object is moved with               */
+/*        r + v dt + a dt^2 / 2 using two-body gravity. The     */
+/*        leading error term is the jerk, roughly mu / r^2      */
+/*        times the angular rate, so the interval is the time   */
+/*        for jerk * dt^3 / 6 to reach the tolerance: about a   */
+/*        minute for LEO and ten minutes or more for GEO.       */
+/****************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include "AdaptiveScheduler.h"
+#include "PropagationBackend.h"
+
+AdaptiveScheduler::AdaptiveScheduler(const vector<Sgp4Sat>& sats, ThreadPool* pool)
+    : sats(sats), pool(pool), propagatedCount(0), numEveryFrame(0) {
+    int n = sats.size();
+
+    interval.assign(n, 0.0);
+    lastTime.assign(n, 0.0);
+    nextDue.assign(n, 0.0);
+    state.assign(n * 6, 0.0);
+    hasState.assign(n, 0);
+    chunkCounts.assign((n + PROPAGATION_CHUNK_SLOTS - 1) / PROPAGATION_CHUNK_SLOTS, 0);
+
+    updateIntervals();
+}
+
+void AdaptiveScheduler::setToleranceKm(double km) {
+    toleranceKm = km;
+    updateIntervals();
+}
+
+void AdaptiveScheduler::updateIntervals() {
+    int everyFrame = 0;
+    for (int i = 0; i < (int)sats.size(); i++) {
+        interval[i] = intervalFor(sats[i]);
+        everyFrame += isEveryFrame(interval[i]);
+    }
+    numEveryFrame.store(everyFrame);
+}
+
+double AdaptiveScheduler::intervalFor(const Sgp4Sat& sat) const {
+    // Mean motion (rad/s) and semi-major axis (km) from the un-Kozai'd mean motion
+    double n = sat.noUnkozai / 60.0;
+    double a = pow(SGP4_XKE / sat.noUnkozai, 2.0 / 3.0) * SGP4_RADIUS_KM;
+
+    // Perigee sets the worst case for eccentric orbits: gravity there times the
+    // angular rate there, with a factor of three for the radial terms
+    double e = min(sat.ecco, 0.99);
+    double rp = max(a * (1.0 - e), SGP4_RADIUS_KM);
+    double rate = n * sqrt(1.0 + e) / pow(1.0 - e, 1.5);
+    double jerk = 3.0 * SGP4_MU / (rp * rp) * rate;
+
+    // Whole frames at the current simulation speed, at least one
+    double seconds = cbrt(6.0 * toleranceKm / jerk);
+    double frames = max(1.0, floor(seconds / simSecondsPerFrame));
+    return frames * simSecondsPerFrame / 86400.0;
+}
+
+void AdaptiveScheduler::replace(int slot, const Sgp4Sat& sat) {
+    sats[slot] = sat;
+    numEveryFrame -= isEveryFrame(interval[slot]);
+    interval[slot] = intervalFor(sat);
+    numEveryFrame += isEveryFrame(interval[slot]);
+    hasState[slot] = 0;
+}
+
+void AdaptiveScheduler::setSimSecondsPerFrame(double seconds) {
+    // Frame times jitter; only re-derive the intervals on a real change of rate
+    if (seconds > 0.0 && fabs(seconds / simSecondsPerFrame - 1.0) > 0.1) {
+        simSecondsPerFrame = seconds;
+        updateIntervals();
+    }
+}
+
+void AdaptiveScheduler::propagateAll(double ds50UTC, GLfloat* points, double kmPerUnit) {
+    int n = sats.size();
+
+    auto sweep = [&](int c) {
+        int first = c * PROPAGATION_CHUNK_SLOTS;
+        int last = min(first + PROPAGATION_CHUNK_SLOTS, n);
+        int propagated = 0;
+
+        for (int i = first; i < last; i++) {
+            double* s = &state[i * 6];
+            double dt = (ds50UTC - lastTime[i]) * 86400.0;
+            double r[3];
+
+            if (!hasState[i] || ds50UTC >= nextDue[i] || fabs(ds50UTC - lastTime[i]) >= interval[i]) {
+                double v[3];
+                int error = sgp4PropagateDs50(sats[i], ds50UTC, r, v);
+                if (error == SGP4_ERR_PENDING) {
+                    continue;
+                }
+                propagated++;
+
+                if (error != SGP4_OK && error != SGP4_ERR_DECAYED) {
+                    continue;
+                }
+
+                // The first update is staggered so objects with equal intervals don't all come due together
+                double stagger = hasState[i] ? 1.0 : fmod((i + 1) * 0.6180339887498949, 1.0);
+                nextDue[i] = ds50UTC + stagger * interval[i];
+
+                copy(r, r + 3, s);
+                copy(v, v + 3, s + 3);
+                lastTime[i] = ds50UTC;
+                hasState[i] = 1;
+            } else {
+                double rmag = sqrt(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+                double g = -SGP4_MU / (rmag * rmag * rmag) * 0.5 * dt * dt;
+
+                for (int k = 0; k < 3; k++) {
+                    r[k] = s[k] + s[k + 3] * dt + g * s[k];
+                }
+            }
+
+            points[i * 3] = r[0] / kmPerUnit;
+            points[i * 3 + 1] = r[2] / kmPerUnit;
+            points[i * 3 + 2] = r[1] / kmPerUnit;
+        }
+
+        chunkCounts[c] = propagated;
+    };
+
+    int numChunks = chunkCounts.size();
+    if (pool != nullptr) {
+        pool->run(numChunks, sweep);
+    } else {
+        for (int c = 0; c < numChunks; c++) {
+            sweep(c);
+        }
+    }
+
+    int total = 0;
+    for (int count : chunkCounts) {
+        total += count;
+    }
+    propagatedCount.store(total);
+}
@@ -0,0 +1,184 @@
+/****************************************************************/
+/*                         CatalogFilter                        */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        Clauses are parsed once into inclusive ranges, so     */
+/*        testing a set is a few comparisons; altitudes are     */
+/*        only derived when a clause needs them.                */
+/****************************************************************/
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+#include "CatalogFilter.h"
+
+namespace {
+
+const double RAD2DEG = 180.0 / 3.14159265358979323846;
+const double TWOPI = 2.0 * 3.14159265358979323846;
+const double INF = numeric_limits<double>::infinity();
+
+// In CatalogFilter::Field order
+const char* FIELD_NAMES[] = {"perigee", "apogee", "incl", "ecc", "period", "age", "id"};
+const int NUM_FIELDS = 7;
+
+bool parseNumber(const string& text, double& value) {
+    if (text.empty()) {
+        return false;
+    }
+
+    char* end;
+    value = strtod(text.c_str(), &end);
+    return *end == '\0';
+}
+
+// "a", "lo..hi", or for ids also "lo-hi"
+bool parseRange(const string& text, bool isId, double& low, double& high) {
+    size_t dots = text.find("..");
+    if (dots != string::npos) {
+        return parseNumber(text.substr(0, dots), low) && parseNumber(text.substr(dots + 2), high) && low <= high;
+    }
+
+    size_t dash = isId ? text.find('-', 1) : string::npos;
+    if (dash != string::npos) {
+        return parseNumber(text.substr(0, dash), low) && parseNumber(text.substr(dash + 1), high) && low <= high;
+    }
+
+    if (!parseNumber(text, low)) {
+        return false;
+    }
+    high = low;
+    return true;
+}
+
+} // namespace
+
+bool CatalogFilter::parse(const string& text, string& error) {
+    vector<Clause> parsed;
+    bool altitudes = false;
+
+    string token;
+    for (size_t i = 0; i <= text.size(); i++) {
+        char c = i < text.size() ? text[i] : ' ';
+        if (!isspace((unsigned char)c) && c != ';') {
+            token += c;
+            continue;
+        }
+        if (token.empty()) {
+            continue;
+        }
+
+        size_t op = token.find_first_of("<>=!");
+        string name = token.substr(0, op);
+        transform(name.begin(), name.end(), name.begin(), [](unsigned char ch) {return tolower(ch);});
+
+        int field = -1;
+        for (int f = 0; f < NUM_FIELDS; f++) {
+            if (name == FIELD_NAMES[f]) {
+                field = f;
+            }
+        }
+        if (op == string::npos || field < 0) {
+            error = "'" + token + "' is not field<op>value with a field of perigee, apogee, incl, ecc, period, age or id";
+            return false;
+        }
+
+        size_t opLength = (op + 1 < token.size() && token[op + 1] == '=') ? 2 : 1;
+        string oper = token.substr(op, opLength);
+        string value = token.substr(op + opLength);
+
+        Clause clause;
+        clause.field = (Field)field;
+        clause.negate = oper == "!=";
+
+        double bound;
+        if (oper == "=" || oper == "!=") {
+            size_t start = 0;
+            while (start <= value.size()) {
+                size_t comma = min(value.find(',', start), value.size());
+                Range range;
+                if (!parseRange(value.substr(start, comma - start), field == FIELD_ID, range.low, range.high)) {
+                    error = "bad value list in '" + token + "'";
+                    return false;
+                }
+                clause.ranges.push_back(range);
+                start = comma + 1;
+            }
+        } else if (oper != "!" && parseNumber(value, bound)) {
+            if (oper == "<") {
+                clause.ranges.push_back({-INF, nextafter(bound, -INF)});
+            } else if (oper == "<=") {
+                clause.ranges.push_back({-INF, bound});
+            } else if (oper == ">") {
+                clause.ranges.push_back({nextafter(bound, INF), INF});
+            } else {
+                clause.ranges.push_back({bound, INF});
+            }
+        } else {
+            error = "bad comparison in '" + token + "'";
+            return false;
+        }
+
+        altitudes = altitudes || field == FIELD_PERIGEE || field == FIELD_APOGEE;
+        parsed.push_back(clause);
+        token.clear();
+    }
+
+    expression = text;
+    clauses.swap(parsed);
+    needsAltitudes = altitudes;
+    return true;
+}
+
+void CatalogFilter::clear() {
+    expression.clear();
+    clauses.clear();
+    needsAltitudes = false;
+}
+
+bool CatalogFilter::usesAge() const {
+    for (const Clause& clause : clauses) {
+        if (clause.field == FIELD_AGE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CatalogFilter::accepts(const TleElements& el) const {
+    double perigee = 0.0, apogee = 0.0;
+    if (needsAltitudes) {
+        meanAltitudes(el, perigee, apogee);
+    }
+
+    for (const Clause& clause : clauses) {
+        double value = 0.0;
+        switch (clause.field) {
+            case FIELD_PERIGEE: value = perigee; break;
+            case FIELD_APOGEE:  value = apogee; break;
+            case FIELD_INCL:    value = el.incl * RAD2DEG; break;
+            case FIELD_ECC:     value = el.ecc; break;
+            case FIELD_PERIOD:  value = TWOPI / el.no; break;
+            case FIELD_AGE:     value = referenceTime - el.epochDs50UTC; break;
+            case FIELD_ID:      value = el.satNum; break;
+        }
+
+        bool inside = false;
+        for (const Range& range : clause.ranges) {
+            if (value >= range.low && value <= range.high) {
+                inside = true;
+                break;
+            }
+        }
+
+        if (inside == clause.negate) {
+            return false;
+        }
+    }
+
+    return true;
+}
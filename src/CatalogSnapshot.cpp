@@ -0,0 +1,181 @@
+/****************************************************************/
+/*                        CatalogSnapshot                       */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        Records are stored exactly as they sit in memory, so  */
+/*        a snapshot is only valid for the build that wrote it; */
+/*        the header's version, byte order and record sizes     */
+/*        reject anything else and the caller falls back to     */
+/*        parsing the TLE text.                                 */
+/****************************************************************/
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+
+#include "CatalogSnapshot.h"
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'S', 'D', 'T', 'S', 'N', 'A', 'P', '\0'};
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+const uint64_t SNAPSHOT_ALIGN = 64;
+
+inline uint64_t alignUp(uint64_t offset) {
+    return (offset + SNAPSHOT_ALIGN - 1) & ~(SNAPSHOT_ALIGN - 1);
+}
+
+// FNV-1a
+inline void hashBytes(uint64_t& hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+}
+
+inline void writePadding(ofstream& out, uint64_t& offset, uint64_t target) {
+    static const char zeros[SNAPSHOT_ALIGN] = {0};
+    out.write(zeros, target - offset);
+    offset = target;
+}
+
+} // namespace
+
+uint64_t CatalogSnapshot::sourceFingerprint(const vector<const char*>& files, double analysisTime, const CatalogFilter& filter) {
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (const char* fileName : files) {
+        struct stat info;
+        int64_t size = -1, modified = -1, modifiedNs = 0;
+
+        if (stat(fileName, &info) == 0) {
+            size = info.st_size;
+            modified = info.st_mtime;
+
+            // A file rewritten within the same second at the same size still differs here
+#if defined(__APPLE__)
+            modifiedNs = info.st_mtimespec.tv_nsec;
+#elif defined(__linux__)
+            modifiedNs = info.st_mtim.tv_nsec;
+#endif
+        }
+
+        hashBytes(hash, fileName, strlen(fileName) + 1);
+        hashBytes(hash, &size, sizeof(size));
+        hashBytes(hash, &modified, sizeof(modified));
+        hashBytes(hash, &modifiedNs, sizeof(modifiedNs));
+    }
+
+    hashBytes(hash, &analysisTime, sizeof(analysisTime));
+
+    // Ages depend on when they are measured from
+    hashBytes(hash, filter.text().c_str(), filter.text().size() + 1);
+    if (filter.usesAge()) {
+        double reference = filter.getReferenceTime();
+        hashBytes(hash, &reference, sizeof(reference));
+    }
+
+    return hash;
+}
+
+bool CatalogSnapshot::write(const char* fileName, uint64_t fingerprint, const vector<TleElements>& elements,
+                            const vector<Sgp4Sat>& sats, const vector<TleElements>& history) {
+    uint64_t count = sats.size();
+
+    if (elements.size() != count) {
+        return false;
+    }
+
+    CatalogSnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = CATALOG_SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.satRecordSize = sizeof(Sgp4Sat);
+    header.elementRecordSize = sizeof(TleElements);
+    header.sourceFingerprint = fingerprint;
+    header.count = count;
+    header.satsOffset = alignUp(sizeof(header));
+    header.elementsOffset = alignUp(header.satsOffset + count * sizeof(Sgp4Sat));
+    header.historyCount = history.size();
+    header.historyOffset = alignUp(header.elementsOffset + count * sizeof(TleElements));
+    header.fileSize = header.historyOffset + history.size() * sizeof(TleElements);
+
+    string tempName = string(fileName) + ".tmp";
+    ofstream out(tempName, ios::binary | ios::trunc);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    uint64_t offset = 0;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    offset += sizeof(header);
+
+    writePadding(out, offset, header.satsOffset);
+    out.write(reinterpret_cast<const char*>(sats.data()), count * sizeof(Sgp4Sat));
+    offset += count * sizeof(Sgp4Sat);
+
+    writePadding(out, offset, header.elementsOffset);
+    out.write(reinterpret_cast<const char*>(elements.data()), count * sizeof(TleElements));
+    offset += count * sizeof(TleElements);
+
+    writePadding(out, offset, header.historyOffset);
+    out.write(reinterpret_cast<const char*>(history.data()), history.size() * sizeof(TleElements));
+
+    out.close();
+    if (out.fail()) {
+        remove(tempName.c_str());
+        return false;
+    }
+
+    // rename() does not replace an existing file on Windows
+    remove(fileName);
+    if (rename(tempName.c_str(), fileName) != 0) {
+        remove(tempName.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool CatalogSnapshot::open(const char* fileName, uint64_t fingerprint) {
+    close();
+
+    if (!file.open(fileName) || file.size() < sizeof(CatalogSnapshotHeader)) {
+        file.close();
+        return false;
+    }
+
+    const CatalogSnapshotHeader* h = reinterpret_cast<const CatalogSnapshotHeader*>(file.data());
+    uint64_t count = h->count;
+
+    bool valid = memcmp(h->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0 &&
+                 h->version == CATALOG_SNAPSHOT_VERSION &&
+                 h->byteOrder == SNAPSHOT_BYTE_ORDER &&
+                 h->satRecordSize == sizeof(Sgp4Sat) &&
+                 h->elementRecordSize == sizeof(TleElements) &&
+                 h->sourceFingerprint == fingerprint &&
+                 h->fileSize == file.size() &&
+                 count < (1ULL << 31) && h->historyCount < (1ULL << 31) &&
+                 h->satsOffset % SNAPSHOT_ALIGN == 0 && h->elementsOffset % SNAPSHOT_ALIGN == 0 &&
+                 h->historyOffset % SNAPSHOT_ALIGN == 0 &&
+                 h->satsOffset + count * sizeof(Sgp4Sat) <= h->fileSize &&
+                 h->elementsOffset + count * sizeof(TleElements) <= h->fileSize &&
+                 h->historyOffset + h->historyCount * sizeof(TleElements) <= h->fileSize;
+
+    if (!valid) {
+        file.close();
+        return false;
+    }
+
+    header = h;
+    return true;
+}
+
+void CatalogSnapshot::close() {
+    header = nullptr;
+    file.close();
+}
@@ -0,0 +1,442 @@
+/****************************************************************/
+/*                        EphemerisCache                        */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        Each satellite's window is cut into equal segments    */
+/*        and every segment gets a degree EPHEM_DEGREE          */
+/*        Chebyshev fit per axis, sampled at the Chebyshev      */
+/*        nodes. The fit is checked against SGP4 halfway        */
+/*        between the nodes; if the error exceeds the           */
+/*        tolerance the segment length is halved and the        */
+/*        satellite refitted. Windows that would need more      */
+/*        coefficients than the memory cap are shortened.       */
+/****************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "EphemerisCache.h"
+
+namespace {
+
+const int EPHEM_DEGREE = 10;
+const int EPHEM_COEFFS = EPHEM_DEGREE + 1;
+const int EPHEM_MAX_HALVINGS = 6;
+const double EPHEM_PI = 3.14159265358979323846;
+
+// Coefficient memory one window may hold; a day of LEO at the finest span is far more
+const double EPHEM_MAX_COEFF_MB = 128.0;
+const double EPHEM_SEGMENT_BYTES = 3 * EPHEM_COEFFS * sizeof(double);
+const double BYTES_PER_MB = 1024.0 * 1024.0;
+
+// Segment length before any halving: a quarter of an orbit is comfortably inside
+// degree 10 for near-circular orbits
+inline double baseSpanDays(const Sgp4Sat& sat, double days) {
+    return min(days, 0.25 * (2.0 * EPHEM_PI / sat.noUnkozai) / 1440.0);
+}
+
+inline int segmentsFor(double days, double span) {
+    return max(1, (int)ceil(days / span - 1.0e-9));
+}
+
+// Evaluate a Chebyshev series at x in [-1, 1] (Clenshaw recurrence)
+inline double chebyshev(const double* c, double x) {
+    double b1 = 0.0, b2 = 0.0;
+    double x2 = 2.0 * x;
+
+    for (int j = EPHEM_DEGREE; j > 0; j--) {
+        double b0 = c[j] + x2 * b1 - b2;
+        b2 = b1;
+        b1 = b0;
+    }
+
+    return c[0] + x * b1 - b2;
+}
+
+} // namespace
+
+EphemerisCache::EphemerisCache() : hits(0), misses(0), refits(0) {
+    worker = thread(&EphemerisCache::workerLoop, this);
+}
+
+EphemerisCache::~EphemerisCache() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+void EphemerisCache::setThreadPool(ThreadPool* pool) {
+    lock_guard<mutex> guard(lock);
+    this->pool = pool;
+}
+
+void EphemerisCache::setCatalog(const vector<Sgp4Sat>& sats, const vector<int>& slots) {
+    shared_ptr<Catalog> cat = make_shared<Catalog>();
+    cat->sats = sats;
+    cat->slots = slots;
+
+    lock_guard<mutex> guard(lock);
+    catalog = cat;
+    window.reset();
+    pendingUpdates.clear();
+}
+
+void EphemerisCache::updateSatellites(const vector<int>& slots, const vector<Sgp4Sat>& sats) {
+    lock_guard<mutex> guard(lock);
+    for (int i = 0; i < (int)slots.size(); i++) {
+        pendingUpdates.emplace_back(slots[i], sats[i]);
+    }
+}
+
+void EphemerisCache::setToleranceKm(double km) {
+    lock_guard<mutex> guard(lock);
+    toleranceKm = km;
+
+    // Refit the current window at the new accuracy
+    if (window != nullptr && !pending) {
+        pending = true;
+        pendingStart = window->start;
+        wake.notify_one();
+    }
+}
+
+void EphemerisCache::setWindowDays(double days) {
+    lock_guard<mutex> guard(lock);
+    windowDays = days;
+}
+
+void EphemerisCache::request(double ds50UTC) {
+    lock_guard<mutex> guard(lock);
+    pending = true;
+    pendingStart = ds50UTC;
+    wake.notify_one();
+}
+
+// Start slightly before the requested time so small steps back still hit. Caller holds the lock.
+void EphemerisCache::queue(double ds50UTC) {
+    pending = true;
+    pendingStart = ds50UTC - 0.05 * windowDays;
+    wake.notify_one();
+}
+
+// Whether a queued or running fit will cover ds50UTC. Caller holds the lock.
+bool EphemerisCache::queuedCovers(double ds50UTC) const {
+    return (pending || fitting) && ds50UTC >= pendingStart && ds50UTC <= pendingStart + windowDays;
+}
+
+shared_ptr<const EphemerisCache::Window> EphemerisCache::current() {
+    lock_guard<mutex> guard(lock);
+    return window;
+}
+
+bool EphemerisCache::evaluate(double ds50UTC, GLfloat* points, double kmPerUnit) {
+    shared_ptr<const Window> w = current();
+
+    if (w == nullptr || ds50UTC < w->start || ds50UTC > w->end) {
+        misses++;
+
+        lock_guard<mutex> guard(lock);
+        if (catalog != nullptr && !queuedCovers(ds50UTC)) {
+            queue(ds50UTC);
+        }
+        return false;
+    }
+
+    hits++;
+
+    // Past the middle of the window: fit the next one while this one is still in use
+    if (ds50UTC > w->start + 0.5 * (w->end - w->start)) {
+        lock_guard<mutex> guard(lock);
+        if (window == w && !pending && !fitting) {
+            queue(ds50UTC);
+        }
+    }
+
+    const vector<int>& slots = w->catalog->slots;
+    double r[3];
+    for (int i = 0; i < (int)slots.size(); i++) {
+        if (evaluateOne(*w, i, ds50UTC, r)) {
+            int s = slots[i];
+            points[s * 3] = r[0] / kmPerUnit;
+            points[s * 3 + 1] = r[2] / kmPerUnit;
+            points[s * 3 + 2] = r[1] / kmPerUnit;
+        }
+    }
+
+    return true;
+}
+
+bool EphemerisCache::covers(double ds50UTC) {
+    shared_ptr<const Window> w = current();
+    return w != nullptr && ds50UTC >= w->start && ds50UTC <= w->end;
+}
+
+bool EphemerisCache::evaluateOne(const Window& w, int i, double ds50UTC, double r[3]) const {
+    int segments = w.numSegments[i];
+    if (segments == 0) {
+        return false;
+    }
+
+    double span = w.span[i];
+    int seg = min((int)((ds50UTC - w.start) / span), segments - 1);
+    double x = 2.0 * (ds50UTC - w.start - seg * span) / span - 1.0;
+
+    const double* c = &w.coeffs[w.offset[i] + seg * 3 * EPHEM_COEFFS];
+    r[0] = chebyshev(c, x);
+    r[1] = chebyshev(c + EPHEM_COEFFS, x);
+    r[2] = chebyshev(c + 2 * EPHEM_COEFFS, x);
+
+    return true;
+}
+
+EphemerisStats EphemerisCache::getStats() {
+    shared_ptr<const Window> w = current();
+
+    EphemerisStats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.refits = refits;
+    stats.maxErrorKm = w != nullptr ? w->maxErrorKm : 0.0;
+    stats.windowStart = w != nullptr ? w->start : 0.0;
+    stats.windowEnd = w != nullptr ? w->end : 0.0;
+    stats.requestedDays = w != nullptr ? w->requestedDays : 0.0;
+    stats.segments = w != nullptr ? w->coeffs.size() / (3 * EPHEM_COEFFS) : 0;
+    stats.coeffMb = w != nullptr ? w->coeffs.size() * sizeof(double) / BYTES_PER_MB : 0.0;
+
+    lock_guard<mutex> guard(lock);
+    stats.lastFitSeconds = lastFitSeconds;
+
+    return stats;
+}
+
+void EphemerisCache::workerLoop() {
+    while (true) {
+        shared_ptr<const Catalog> cat;
+        double start, days, tolerance;
+        ThreadPool* workers;
+        vector<pair<int, Sgp4Sat>> updates;
+
+        {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [this] {return stopping || pending;});
+
+            if (stopping) {
+                return;
+            }
+
+            pending = false;
+            fitting = true;
+            cat = catalog;
+            start = pendingStart;
+            days = windowDays;
+            tolerance = toleranceKm;
+            workers = pool;
+            updates.swap(pendingUpdates);
+        }
+
+        if (cat == nullptr) {
+            continue;
+        }
+
+        // Copy the catalog with the switched element sets off the lock
+        if (!updates.empty()) {
+            shared_ptr<Catalog> updated = make_shared<Catalog>(*cat);
+
+            vector<int> indexOfSlot;
+            for (int i = 0; i < (int)updated->slots.size(); i++) {
+                int slot = updated->slots[i];
+                if (slot >= (int)indexOfSlot.size()) {
+                    indexOfSlot.resize(slot + 1, -1);
+                }
+                indexOfSlot[slot] = i;
+            }
+            for (const pair<int, Sgp4Sat>& update : updates) {
+                if (update.first < (int)indexOfSlot.size() && indexOfSlot[update.first] >= 0) {
+                    updated->sats[indexOfSlot[update.first]] = update.second;
+                }
+            }
+            updates.clear();
+
+            // Unless setCatalog replaced it meanwhile
+            lock_guard<mutex> guard(lock);
+            if (catalog == cat) {
+                catalog = updated;
+            }
+            cat = catalog;
+        }
+
+        auto began = chrono::steady_clock::now();
+        shared_ptr<Window> fitted = fit(cat, start, days, tolerance, workers);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - began).count();
+
+        lock_guard<mutex> guard(lock);
+        fitting = false;
+
+        // A newer catalog replaces anything fitted from the old one
+        if (cat == catalog) {
+            window = fitted;
+            lastFitSeconds = seconds;
+            refits++;
+        }
+    }
+}
+
+shared_ptr<EphemerisCache::Window> EphemerisCache::fit(const shared_ptr<const Catalog>& cat, double start, double days, double tolerance, ThreadPool* workers) {
+    int n = cat->sats.size();
+    long long maxSegments = (long long)(EPHEM_MAX_COEFF_MB * BYTES_PER_MB / EPHEM_SEGMENT_BYTES);
+
+    shared_ptr<Window> w = make_shared<Window>();
+    w->catalog = cat;
+    w->start = start;
+    w->requestedDays = days;
+
+    // Shorten the window up front when even unhalved segments would exceed the cap
+    double baseSegments = 0.0;
+    for (const Sgp4Sat& sat : cat->sats) {
+        baseSegments += days / baseSpanDays(sat, days);
+    }
+    if (baseSegments > maxSegments) {
+        days *= maxSegments / baseSegments;
+    }
+
+    w->span.assign(n, days);
+    w->numSegments.assign(n, 0);
+    w->offset.assign(n + 1, 0);
+
+    // Satellites are fitted independently; error and coefficients are gathered per satellite
+    vector<vector<double>> perSat(n);
+    vector<double> error(n, 0.0);
+
+    auto task = [&](int i) {
+        const Sgp4Sat& sat = cat->sats[i];
+        double span = baseSpanDays(sat, days);
+
+        for (int h = 0; h <= EPHEM_MAX_HALVINGS; h++) {
+            error[i] = fitSatellite(sat, start, days, span, perSat[i]);
+            if (error[i] <= tolerance || error[i] < 0.0 || h == EPHEM_MAX_HALVINGS) {
+                break;
+            }
+            span *= 0.5;
+        }
+
+        if (error[i] < 0.0) {
+            perSat[i].clear();
+            error[i] = 0.0;
+        }
+        w->span[i] = span;
+    };
+
+    if (workers != nullptr) {
+        workers->run(n, task);
+    } else {
+        for (int i = 0; i < n; i++) {
+            task(i);
+        }
+    }
+
+    long long totalSegments = 0;
+    for (int i = 0; i < n; i++) {
+        w->numSegments[i] = perSat[i].size() / (3 * EPHEM_COEFFS);
+        totalSegments += w->numSegments[i];
+    }
+
+    // Halving pushed it over: keep the longest window whose leading segments fit. Every
+    // fitted satellite keeps at least one segment, so a huge catalog may still exceed it.
+    if (totalSegments > maxSegments) {
+        double low = 0.0, high = days;
+        for (int iter = 0; iter < 50; iter++) {
+            double mid = 0.5 * (low + high);
+            long long count = 0;
+            for (int i = 0; i < n; i++) {
+                if (w->numSegments[i] > 0) {
+                    count += min(w->numSegments[i], segmentsFor(mid, w->span[i]));
+                }
+            }
+            if (count <= maxSegments) {
+                low = mid;
+            } else {
+                high = mid;
+            }
+        }
+
+        days = max(low, 1.0 / 1440.0);
+        for (int i = 0; i < n; i++) {
+            if (w->numSegments[i] > 0) {
+                w->numSegments[i] = min(w->numSegments[i], segmentsFor(days, w->span[i]));
+            }
+        }
+    }
+    w->end = start + days;
+
+    w->maxErrorKm = 0.0;
+    for (int i = 0; i < n; i++) {
+        w->offset[i + 1] = w->offset[i] + w->numSegments[i] * 3 * EPHEM_COEFFS;
+        w->maxErrorKm = max(w->maxErrorKm, error[i]);
+    }
+
+    w->coeffs.resize(w->offset[n]);
+    for (int i = 0; i < n; i++) {
+        copy(perSat[i].begin(), perSat[i].begin() + (w->offset[i + 1] - w->offset[i]), w->coeffs.begin() + w->offset[i]);
+    }
+
+    return w;
+}
+
+// Fit one satellite with segments of the given span. Returns the largest check-point
+// error in km, or -1 when SGP4 fails anywhere in the window.
+double EphemerisCache::fitSatellite(const Sgp4Sat& sat, double start, double days, double span, vector<double>& out) {
+    int segments = max(1, (int)ceil(days / span - 1.0e-9));
+    out.assign(segments * 3 * EPHEM_COEFFS, 0.0);
+
+    double samples[EPHEM_COEFFS][3];
+    double r[3], v[3];
+    double maxError = 0.0;
+
+    for (int seg = 0; seg < segments; seg++) {
+        double segStart = start + seg * span;
+        double* c = &out[seg * 3 * EPHEM_COEFFS];
+
+        // Sample at the Chebyshev nodes
+        for (int k = 0; k < EPHEM_COEFFS; k++) {
+            double x = cos(EPHEM_PI * (k + 0.5) / EPHEM_COEFFS);
+            int status = sgp4PropagateDs50(sat, segStart + 0.5 * (x + 1.0) * span, r, v);
+            if (status != SGP4_OK && status != SGP4_ERR_DECAYED) {
+                return -1.0;
+            }
+            samples[k][0] = r[0];
+            samples[k][1] = r[1];
+            samples[k][2] = r[2];
+        }
+
+        for (int axis = 0; axis < 3; axis++) {
+            for (int j = 0; j < EPHEM_COEFFS; j++) {
+                double sum = 0.0;
+                for (int k = 0; k < EPHEM_COEFFS; k++) {
+                    sum += samples[k][axis] * cos(EPHEM_PI * j * (k + 0.5) / EPHEM_COEFFS);
+                }
+                c[axis * EPHEM_COEFFS + j] = (j == 0 ? 1.0 : 2.0) * sum / EPHEM_COEFFS;
+            }
+        }
+
+        // Check between the nodes, including both segment ends
+        for (int k = 0; k <= EPHEM_COEFFS; k++) {
+            double x = cos(EPHEM_PI * k / EPHEM_COEFFS);
+            int status = sgp4PropagateDs50(sat, segStart + 0.5 * (x + 1.0) * span, r, v);
+            if (status != SGP4_OK && status != SGP4_ERR_DECAYED) {
+                return -1.0;
+            }
+
+            double dx = chebyshev(c, x) - r[0];
+            double dy = chebyshev(c + EPHEM_COEFFS, x) - r[1];
+            double dz = chebyshev(c + 2 * EPHEM_COEFFS, x) - r[2];
+            maxError = max(maxError, sqrt(dx * dx + dy * dy + dz * dz));
+        }
+    }
+
+    return maxError;
+}
@@ -0,0 +1,82 @@
+/****************************************************************/
+/*                        EphemerisTable                        */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        Workers take contiguous runs of satellites and sweep  */
+/*        each one through every timestep, so the SGP4 record   */
+/*        stays in cache and only the output stream moves.      */
+/****************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "EphemerisTable.h"
+
+namespace {
+
+// Satellites per worker task; a whole number of cache lines of a [t][sat] row
+const int EPHEM_TABLE_CHUNK = CACHE_LINE_BYTES;
+
+} // namespace
+
+void EphemerisTable::resize(int sats, double startDs50UTC, double step, int steps, EphemerisLayout order) {
+    numSats = sats;
+    numSteps = steps;
+    start = startDs50UTC;
+    stepMinutes = step;
+    layout = order;
+
+    positions.assign((size_t)numSats * numSteps * 3, numeric_limits<double>::quiet_NaN());
+    valid.assign((size_t)numSats * numSteps, 0);
+}
+
+void EphemerisTable::set(int sat, int step, const double pos[3], bool ok) {
+    size_t i = index(sat, step);
+
+    positions[i * 3] = pos[0];
+    positions[i * 3 + 1] = pos[1];
+    positions[i * 3 + 2] = pos[2];
+    valid[i] = ok ? 1 : 0;
+}
+
+void EphemerisTable::generate(const vector<Sgp4Sat>& sats, double startDs50UTC, double step, int steps,
+                              EphemerisLayout order, ThreadPool* pool) {
+    resize(sats.size(), startDs50UTC, step, steps, order);
+    sweep([&](int s) -> const Sgp4Sat& {return sats[s];}, pool);
+}
+
+void EphemerisTable::generate(const PropagatorContext& context, const vector<int>& slots, double startDs50UTC,
+                              double step, int steps, EphemerisLayout order, ThreadPool* pool) {
+    resize(slots.size(), startDs50UTC, step, steps, order);
+    sweep([&](int s) -> const Sgp4Sat& {return context.satellite(slots[s]);}, pool);
+}
+
+void EphemerisTable::sweep(const function<const Sgp4Sat&(int)>& satellite, ThreadPool* pool) {
+    int numChunks = (numSats + EPHEM_TABLE_CHUNK - 1) / EPHEM_TABLE_CHUNK;
+
+    auto chunk = [&](int c) {
+        int first = c * EPHEM_TABLE_CHUNK;
+        int last = min(first + EPHEM_TABLE_CHUNK, numSats);
+        double r[3], v[3];
+
+        for (int s = first; s < last; s++) {
+            const Sgp4Sat& sat = satellite(s);
+            double offset = (start - sat.epochDs50UTC) * 1440.0;
+
+            for (int t = 0; t < numSteps; t++) {
+                int error = sgp4Propagate(sat, offset + t * stepMinutes, r, v);
+                set(s, t, r, error == SGP4_OK || error == SGP4_ERR_DECAYED);
+            }
+        }
+    };
+
+    if (pool != nullptr) {
+        pool->run(numChunks, chunk);
+    } else {
+        for (int c = 0; c < numChunks; c++) {
+            chunk(c);
+        }
+    }
+}
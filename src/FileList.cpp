@@ -0,0 +1,96 @@
+/****************************************************************/
+/*                           FileList                           */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        opendir/fnmatch on POSIX, FindFirstFile on Windows.   */
+/****************************************************************/
+
+#include <algorithm>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fnmatch.h>
+#endif
+
+#include "FileList.h"
+
+namespace {
+
+bool isDirectory(const string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && (info.st_mode & S_IFMT) == S_IFDIR;
+}
+
+bool isRegularFile(const string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && (info.st_mode & S_IFMT) == S_IFREG;
+}
+
+// Regular files in directory whose names match pattern, with the directory prefixed
+void listDirectory(const string& directory, const string& pattern, vector<string>& matches) {
+    string prefix = directory.empty() ? "" : directory + "/";
+
+#ifdef _WIN32
+    WIN32_FIND_DATAA found;
+    HANDLE search = FindFirstFileA((prefix + pattern).c_str(), &found);
+    if (search == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    do {
+        if (!(found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+            matches.push_back(prefix + found.cFileName);
+        }
+    } while (FindNextFileA(search, &found));
+
+    FindClose(search);
+#else
+    DIR* dir = opendir(directory.empty() ? "." : directory.c_str());
+    if (dir == nullptr) {
+        return;
+    }
+
+    for (dirent* entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+        string name = entry->d_name;
+        if (name == "." || name == ".." || fnmatch(pattern.c_str(), name.c_str(), FNM_PERIOD) != 0) {
+            continue;
+        }
+
+        if (isRegularFile(prefix + name)) {
+            matches.push_back(prefix + name);
+        }
+    }
+
+    closedir(dir);
+#endif
+}
+
+} // namespace
+
+bool expandPath(const string& path, vector<string>& files) {
+    vector<string> matches;
+
+    if (isDirectory(path)) {
+        string directory = path;
+        while (directory.size() > 1 && (directory.back() == '/' || directory.back() == '\\')) {
+            directory.pop_back();
+        }
+        listDirectory(directory, "*", matches);
+    } else if (path.find_first_of("*?[") != string::npos) {
+        size_t split = path.find_last_of("/\\");
+        string directory = split == string::npos ? "" : path.substr(0, split);
+        string pattern = split == string::npos ? path : path.substr(split + 1);
+        listDirectory(directory, pattern, matches);
+    } else if (isRegularFile(path)) {
+        matches.push_back(path);
+    }
+
+    sort(matches.begin(), matches.end());
+    files.insert(files.end(), matches.begin(), matches.end());
+
+    return !matches.empty();
+}
@@ -0,0 +1,240 @@
+/****************************************************************/
+/*                          FileWatcher                         */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        The parent directory of every source is watched, so   */
+/*        files that do not exist yet and files replaced by a   */
+/*        rename are both seen. Only close-after-write and      */
+/*        moved-in events count; a file still being written is  */
+/*        picked up once its writer closes it.                  */
+/****************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <set>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "FileWatcher.h"
+#include "FileList.h"
+
+namespace {
+
+// A batch is handed over once no event has arrived for this long
+const int SETTLE_MS = 500;
+// How often stop() is noticed while waiting for events
+const int WAKE_MS = 200;
+// Modification time polling interval where inotify is not available
+const int POLL_MS = 2000;
+
+bool isDirectory(const string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && (info.st_mode & S_IFMT) == S_IFDIR;
+}
+
+// Directory holding the files a source names, spelled the way expandPath prefixes them
+string sourceDirectory(const string& source) {
+    if (isDirectory(source)) {
+        string directory = source;
+        while (directory.size() > 1 && (directory.back() == '/' || directory.back() == '\\')) {
+            directory.pop_back();
+        }
+        return directory;
+    }
+
+    size_t split = source.find_last_of("/\\");
+    return split == string::npos ? "" : source.substr(0, split);
+}
+
+} // namespace
+
+FileWatcher::~FileWatcher() {
+    stop();
+}
+
+bool FileWatcher::start(const vector<string>& sourceList, ChangeHandler handler) {
+    stop();
+
+    sources = sourceList;
+    onChange = handler;
+
+    vector<string> directories;
+    for (const string& source : sources) {
+        string directory = sourceDirectory(source);
+        if (find(directories.begin(), directories.end(), directory) == directories.end()) {
+            directories.push_back(directory);
+        }
+    }
+
+#ifdef __linux__
+    notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (notifyFd < 0) {
+        return false;
+    }
+
+    watches.clear();
+    for (const string& directory : directories) {
+        int wd = inotify_add_watch(notifyFd, directory.empty() ? "." : directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd >= 0) {
+            watches.emplace_back(wd, directory);
+        }
+    }
+
+    if (watches.empty()) {
+        close(notifyFd);
+        notifyFd = -1;
+        return false;
+    }
+
+    running.store(true);
+    watcher = thread(&FileWatcher::watchLoop, this);
+#else
+    running.store(true);
+    watcher = thread(&FileWatcher::pollLoop, this);
+#endif
+
+    return true;
+}
+
+void FileWatcher::stop() {
+    running.store(false);
+
+    if (watcher.joinable()) {
+        watcher.join();
+    }
+
+#ifdef __linux__
+    if (notifyFd >= 0) {
+        close(notifyFd);
+        notifyFd = -1;
+    }
+#endif
+}
+
+vector<string> FileWatcher::matchSources(const vector<string>& changed) const {
+    vector<string> current;
+    for (const string& source : sources) {
+        expandPath(source, current);
+    }
+
+    set<string> wanted(changed.begin(), changed.end());
+    vector<string> matches;
+    for (const string& file : current) {
+        if (wanted.count(file) > 0 && find(matches.begin(), matches.end(), file) == matches.end()) {
+            matches.push_back(file);
+        }
+    }
+
+    sort(matches.begin(), matches.end());
+    return matches;
+}
+
+void FileWatcher::watchLoop() {
+#ifdef __linux__
+    map<int, string> directoryOf(watches.begin(), watches.end());
+
+    alignas(inotify_event) char buffer[16384];
+    vector<string> changed;
+    auto lastEvent = chrono::steady_clock::now();
+
+    while (running.load()) {
+        pollfd request = {notifyFd, POLLIN, 0};
+        int ready = poll(&request, 1, WAKE_MS);
+
+        if (ready > 0) {
+            ssize_t length;
+            while ((length = read(notifyFd, buffer, sizeof(buffer))) > 0) {
+                for (char* at = buffer; at < buffer + length;) {
+                    const inotify_event* event = reinterpret_cast<const inotify_event*>(at);
+                    auto directory = directoryOf.find(event->wd);
+
+                    if (event->len > 0 && directory != directoryOf.end()) {
+                        string name = event->name;
+                        changed.push_back(directory->second.empty() ? name : directory->second + "/" + name);
+                    }
+
+                    at += sizeof(inotify_event) + event->len;
+                }
+            }
+            lastEvent = chrono::steady_clock::now();
+            continue;
+        }
+
+        bool settled = chrono::steady_clock::now() - lastEvent >= chrono::milliseconds(SETTLE_MS);
+        if (!changed.empty() && settled) {
+            vector<string> matches = matchSources(changed);
+            changed.clear();
+
+            if (!matches.empty()) {
+                onChange(matches);
+            }
+        }
+    }
+#endif
+}
+
+void FileWatcher::pollLoop() {
+    // Size and modification time of every file the sources name
+    auto scan = [this]() {
+        vector<string> files;
+        for (const string& source : sources) {
+            expandPath(source, files);
+        }
+
+        map<string, pair<long long, long long>> stamps;
+        for (const string& file : files) {
+            struct stat info;
+            if (stat(file.c_str(), &info) == 0) {
+                stamps[file] = make_pair((long long)info.st_size, (long long)info.st_mtime);
+            }
+        }
+        return stamps;
+    };
+
+    map<string, pair<long long, long long>> known = scan();
+    vector<string> changed;
+
+    while (running.load()) {
+        for (int waited = 0; waited < POLL_MS && running.load(); waited += WAKE_MS) {
+            this_thread::sleep_for(chrono::milliseconds(WAKE_MS));
+        }
+
+        map<string, pair<long long, long long>> latest = scan();
+        vector<string> modified;
+        for (const auto& file : latest) {
+            auto previous = known.find(file.first);
+            if (previous == known.end() || previous->second != file.second) {
+                modified.push_back(file.first);
+            }
+        }
+        known = latest;
+
+        // A file still changing is reported on the first scan that finds it unchanged
+        vector<string> settled;
+        for (const string& file : changed) {
+            if (find(modified.begin(), modified.end(), file) == modified.end()) {
+                settled.push_back(file);
+            }
+        }
+        changed.erase(remove_if(changed.begin(), changed.end(), [&](const string& file) {
+            return find(settled.begin(), settled.end(), file) != settled.end();
+        }), changed.end());
+        for (const string& file : modified) {
+            if (find(changed.begin(), changed.end(), file) == changed.end()) {
+                changed.push_back(file);
+            }
+        }
+
+        if (!settled.empty()) {
+            sort(settled.begin(), settled.end());
+            onChange(settled);
+        }
+    }
+}
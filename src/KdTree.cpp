@@ -0,0 +1,276 @@
+/****************************************************************/
+/*                             KdTree                           */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        Each level splits every node at the median of its     */
+/*        widest axis with nth_element; the nodes of a level    */
+/*        are independent, so a level is one parallel job.      */
+/*        Batch queries walk the objects in leaf order, so      */
+/*        neighbouring queries touch the same buckets.          */
+/****************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "KdTree.h"
+
+using namespace std;
+
+namespace {
+
+// Objects per batch query task
+const int QUERY_CHUNK = 1024;
+
+// Max-heap on distance: the worst of the k best is at the front
+bool farther(const KdNeighbour& a, const KdNeighbour& b) {
+    return a.distance < b.distance;
+}
+
+double coordinate(double x, double y, double z, int axis) {
+    return axis == 0 ? x : (axis == 1 ? y : z);
+}
+
+} // namespace
+
+KdTree::KdTree(const vector<SpaceDebris>& debris_list, ThreadPool* pool) {
+    this->debris_list = debris_list;
+    this->pool = pool;
+
+    int n = debris_list.size();
+
+    points.resize(n);
+    for (int i = 0; i < n; i++) {
+        points[i] = {debris_list[i].x, debris_list[i].y, debris_list[i].z, i};
+    }
+
+    // Halve ranges until every leaf holds at most LEAF_SIZE points
+    leafDepth = 0;
+    while ((long long)LEAF_SIZE << leafDepth < n) {
+        leafDepth++;
+    }
+    firstLeaf = (1 << leafDepth) - 1;
+
+    int numNodes = (2 << leafDepth) - 1;
+    nodeBegin.assign(numNodes, 0);
+    nodeEnd.assign(numNodes, 0);
+    splitAxis.assign(firstLeaf, 0);
+    splitValue.assign(firstLeaf, 0.0);
+    nodeBox.assign(numNodes * 6, 0.0);
+    nodeEnd[0] = n;
+
+    double* rootBox = &nodeBox[0];
+    for (int a = 0; a < 3; a++) {
+        rootBox[a] = numeric_limits<double>::max();
+        rootBox[a + 3] = numeric_limits<double>::lowest();
+    }
+    for (const Point& p : points) {
+        rootBox[0] = min(rootBox[0], p.x);
+        rootBox[1] = min(rootBox[1], p.y);
+        rootBox[2] = min(rootBox[2], p.z);
+        rootBox[3] = max(rootBox[3], p.x);
+        rootBox[4] = max(rootBox[4], p.y);
+        rootBox[5] = max(rootBox[5], p.z);
+    }
+
+    for (int depth = 0; depth < leafDepth; depth++) {
+        int first = (1 << depth) - 1;
+        run(1 << depth, [&](int i) {
+            split_node(first + i);
+        });
+    }
+}
+
+// Partition a node's points at the median of its region's widest axis and set up both children
+void KdTree::split_node(int node) {
+    int begin = nodeBegin[node];
+    int end = nodeEnd[node];
+    int mid = begin + (end - begin) / 2;
+    const double* box = &nodeBox[node * 6];
+
+    int axis = 0;
+    for (int a = 1; a < 3; a++) {
+        if (box[a + 3] - box[a] > box[axis + 3] - box[axis]) {
+            axis = a;
+        }
+    }
+
+    // One comparator per axis keeps the axis test out of the partition loop
+    auto first = points.begin() + begin;
+    auto median = points.begin() + mid;
+    auto last = points.begin() + end;
+    if (mid < end && axis == 0) {
+        nth_element(first, median, last, [](const Point& a, const Point& b) {return a.x < b.x;});
+    } else if (mid < end && axis == 1) {
+        nth_element(first, median, last, [](const Point& a, const Point& b) {return a.y < b.y;});
+    } else if (mid < end) {
+        nth_element(first, median, last, [](const Point& a, const Point& b) {return a.z < b.z;});
+    }
+
+    splitAxis[node] = axis;
+    splitValue[node] = mid < end ? coordinate(points[mid].x, points[mid].y, points[mid].z, axis) : 0.0;
+
+    int left = 2 * node + 1;
+    int right = 2 * node + 2;
+    nodeBegin[left] = begin;
+    nodeEnd[left] = mid;
+    nodeBegin[right] = mid;
+    nodeEnd[right] = end;
+
+    copy(box, box + 6, &nodeBox[left * 6]);
+    copy(box, box + 6, &nodeBox[right * 6]);
+    nodeBox[left * 6 + axis + 3] = splitValue[node];
+    nodeBox[right * 6 + axis] = splitValue[node];
+}
+
+// Distances in the heap are squared until the query returns
+void KdTree::search_knn(int node, const double query[3], int k, vector<KdNeighbour>& heap) const {
+    if (node >= firstLeaf) {
+        for (int i = nodeBegin[node]; i < nodeEnd[node]; i++) {
+            double dx = points[i].x - query[0];
+            double dy = points[i].y - query[1];
+            double dz = points[i].z - query[2];
+            double dist2 = dx * dx + dy * dy + dz * dz;
+
+            if (is_same_object(dist2)) {
+                continue;
+            }
+
+            if ((int)heap.size() < k) {
+                heap.push_back({points[i].index, dist2});
+                push_heap(heap.begin(), heap.end(), farther);
+            } else if (dist2 < heap.front().distance) {
+                pop_heap(heap.begin(), heap.end(), farther);
+                heap.back() = {points[i].index, dist2};
+                push_heap(heap.begin(), heap.end(), farther);
+            }
+        }
+        return;
+    }
+
+    double diff = query[splitAxis[node]] - splitValue[node];
+    int nearChild = diff < 0.0 ? 2 * node + 1 : 2 * node + 2;
+    int farChild = diff < 0.0 ? 2 * node + 2 : 2 * node + 1;
+
+    search_knn(nearChild, query, k, heap);
+    if ((int)heap.size() < k || diff * diff < heap.front().distance) {
+        search_knn(farChild, query, k, heap);
+    }
+}
+
+void KdTree::search_radius(int node, const double query[3], double radius2, vector<KdNeighbour>& result) const {
+    if (node >= firstLeaf) {
+        for (int i = nodeBegin[node]; i < nodeEnd[node]; i++) {
+            double dx = points[i].x - query[0];
+            double dy = points[i].y - query[1];
+            double dz = points[i].z - query[2];
+            double dist2 = dx * dx + dy * dy + dz * dz;
+
+            if (is_risky_pair(dist2, radius2)) {
+                result.push_back({points[i].index, sqrt(dist2)});
+            }
+        }
+        return;
+    }
+
+    double diff = query[splitAxis[node]] - splitValue[node];
+    int nearChild = diff < 0.0 ? 2 * node + 1 : 2 * node + 2;
+    int farChild = diff < 0.0 ? 2 * node + 2 : 2 * node + 1;
+
+    search_radius(nearChild, query, radius2, result);
+    if (diff * diff <= radius2) {
+        search_radius(farChild, query, radius2, result);
+    }
+}
+
+void KdTree::knn(double x, double y, double z, int k, vector<KdNeighbour>& result) const {
+    double query[3] = {x, y, z};
+
+    result.clear();
+    if (k <= 0) {
+        return;
+    }
+
+    search_knn(0, query, k, result);
+
+    sort_heap(result.begin(), result.end(), farther);
+    for (KdNeighbour& neighbour : result) {
+        neighbour.distance = sqrt(neighbour.distance);
+    }
+}
+
+void KdTree::radius(double x, double y, double z, double radius, vector<KdNeighbour>& result) const {
+    double query[3] = {x, y, z};
+
+    result.clear();
+    search_radius(0, query, radius * radius, result);
+}
+
+void KdTree::knn_all(int k, vector<KdNeighbour>& result) const {
+    int n = points.size();
+    result.assign((size_t)n * max(k, 0), {-1, numeric_limits<double>::infinity()});
+
+    int numChunks = (n + QUERY_CHUNK - 1) / QUERY_CHUNK;
+    run(numChunks, [&](int c) {
+        vector<KdNeighbour> neighbours;
+        int end = min(n, (c + 1) * QUERY_CHUNK);
+
+        for (int i = c * QUERY_CHUNK; i < end; i++) {
+            const Point& p = points[i];
+            knn(p.x, p.y, p.z, k, neighbours);
+            copy(neighbours.begin(), neighbours.end(), result.begin() + (size_t)p.index * k);
+        }
+    });
+}
+
+void KdTree::find_pairs(double radius, vector<DebrisPair>& pairs) const {
+    int n = points.size();
+    int numChunks = (n + QUERY_CHUNK - 1) / QUERY_CHUNK;
+    vector<vector<DebrisPair>> chunkPairs(numChunks);
+
+    run(numChunks, [&](int c) {
+        vector<KdNeighbour> neighbours;
+        int end = min(n, (c + 1) * QUERY_CHUNK);
+
+        for (int i = c * QUERY_CHUNK; i < end; i++) {
+            const Point& p = points[i];
+            this->radius(p.x, p.y, p.z, radius, neighbours);
+
+            // Each pair is found from both ends; keep it once
+            for (const KdNeighbour& neighbour : neighbours) {
+                if (p.index < neighbour.index) {
+                    chunkPairs[c].push_back({p.index, neighbour.index, neighbour.distance});
+                }
+            }
+        }
+    });
+
+    for (const vector<DebrisPair>& found : chunkPairs) {
+        pairs.insert(pairs.end(), found.begin(), found.end());
+    }
+}
+
+void KdTree::find_risky_debris(double tolerance, vector<SpaceDebris>& riskList) const {
+    vector<KdNeighbour> nearest;
+    knn_all(1, nearest);
+
+    for (int i = 0; i < (int)nearest.size(); i++) {
+        if (nearest[i].index >= 0 && nearest[i].distance <= tolerance) {
+            SpaceDebris entry = debris_list[i];
+            entry.riskyOther = debris_list[nearest[i].index].id;
+            entry.riskDistance = nearest[i].distance;
+            riskList.push_back(entry);
+        }
+    }
+}
+
+void KdTree::run(int numTasks, const function<void(int)>& task) const {
+    if (pool != nullptr) {
+        pool->run(numTasks, task);
+    } else {
+        for (int i = 0; i < numTasks; i++) {
+            task(i);
+        }
+    }
+}
@@ -0,0 +1,172 @@
+/****************************************************************/
+/*                          LinearOctree                        */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        Build: bounds, Morton keys and a radix sort, all      */
+/*        linear passes over flat arrays. Search: each leaf     */
+/*        against itself and the 13 neighbours after it in a    */
+/*        fixed stencil order, so every adjacent pair of        */
+/*        leaves is compared exactly once.                      */
+/****************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "LinearOctree.h"
+#include "RadixSort.h"
+
+using namespace std;
+
+namespace {
+
+const int MORTON_BITS = 21;
+const uint32_t MORTON_MAX = (1u << MORTON_BITS) - 1;
+
+// Spread the low 21 bits of v two bits apart
+uint64_t splitBits(uint32_t v) {
+    uint64_t x = v & 0x1fffff;
+    x = (x | x << 32) & 0x1f00000000ffffULL;
+    x = (x | x << 16) & 0x1f0000ff0000ffULL;
+    x = (x | x << 8)  & 0x100f00f00f00f00fULL;
+    x = (x | x << 4)  & 0x10c30c30c30c30c3ULL;
+    x = (x | x << 2)  & 0x1249249249249249ULL;
+    return x;
+}
+
+uint32_t compactBits(uint64_t x) {
+    x &= 0x1249249249249249ULL;
+    x = (x | x >> 2)  & 0x10c30c30c30c30c3ULL;
+    x = (x | x >> 4)  & 0x100f00f00f00f00fULL;
+    x = (x | x >> 8)  & 0x1f0000ff0000ffULL;
+    x = (x | x >> 16) & 0x1f00000000ffffULL;
+    x = (x | x >> 32) & 0x1fffff;
+    return (uint32_t)x;
+}
+
+} // namespace
+
+uint64_t mortonEncode(uint32_t x, uint32_t y, uint32_t z) {
+    return splitBits(x) | splitBits(y) << 1 | splitBits(z) << 2;
+}
+
+void mortonDecode(uint64_t key, uint32_t& x, uint32_t& y, uint32_t& z) {
+    x = compactBits(key);
+    y = compactBits(key >> 1);
+    z = compactBits(key >> 2);
+}
+
+LinearOctree::LinearOctree(const vector<SpaceDebris>& debris_list, double tolerance) {
+    this->debris_list = debris_list;
+    this->tolerance = tolerance;
+
+    int n = debris_list.size();
+
+    double min_x, min_y, min_z, max_x, max_y, max_z;
+
+    min_x = min_y = min_z = numeric_limits<double>::max();
+
+    max_x = max_y = max_z = numeric_limits<double>::lowest();
+
+    for (const auto& debris : debris_list) {
+        min_x = min(min_x, debris.x);
+        max_x = max(max_x, debris.x);
+        min_y = min(min_y, debris.y);
+        max_y = max(max_y, debris.y);
+        min_z = min(min_z, debris.z);
+        max_z = max(max_z, debris.z);
+    }
+
+    // Leaves no narrower than the tolerance, so a pair is always in the same or adjacent leaves
+    double extent = n > 0 ? max(max_x - min_x, max(max_y - min_y, max_z - min_z)) : 0.0;
+    leafSize = max(max(tolerance, extent / MORTON_MAX), numeric_limits<double>::min());
+
+    vector<uint64_t> keys(n);
+    order.resize(n);
+    for (int i = 0; i < n; i++) {
+        const SpaceDebris& debris = debris_list[i];
+        uint32_t cx = min((uint32_t)((debris.x - min_x) / leafSize), MORTON_MAX);
+        uint32_t cy = min((uint32_t)((debris.y - min_y) / leafSize), MORTON_MAX);
+        uint32_t cz = min((uint32_t)((debris.z - min_z) / leafSize), MORTON_MAX);
+        keys[i] = mortonEncode(cx, cy, cz);
+        order[i] = i;
+    }
+
+    radixSort(keys, order);
+
+    // Positions in leaf order, and one leaf per run of equal keys
+    xs.resize(n);
+    ys.resize(n);
+    zs.resize(n);
+    for (int i = 0; i < n; i++) {
+        const SpaceDebris& debris = debris_list[order[i]];
+        xs[i] = debris.x;
+        ys[i] = debris.y;
+        zs[i] = debris.z;
+
+        if (i == 0 || keys[i] != keys[i - 1]) {
+            leafKeys.push_back(keys[i]);
+            leafStart.push_back(i);
+        }
+    }
+    leafStart.push_back(n);
+}
+
+// Compare the objects of leaf a with those of leaf b, or with each other when a == b
+void LinearOctree::compare_leaves(int a, int b, vector<DebrisPair>& pairs) const {
+    double tolerance2 = tolerance * tolerance;
+
+    for (int i = leafStart[a]; i < leafStart[a + 1]; i++) {
+        int first = a == b ? i + 1 : leafStart[b];
+
+        for (int j = first; j < leafStart[b + 1]; j++) {
+            double dx = xs[i] - xs[j];
+            double dy = ys[i] - ys[j];
+            double dz = zs[i] - zs[j];
+            double dist2 = dx * dx + dy * dy + dz * dz;
+
+            if (is_risky_pair(dist2, tolerance2)) {
+                pairs.push_back({order[i], order[j], sqrt(dist2)});
+            }
+        }
+    }
+}
+
+void LinearOctree::find_pairs(vector<DebrisPair>& pairs) const {
+    // Half of the 26 neighbours; the other half see this leaf in their own stencil
+    static const int offsets[13][3] = {
+        {1, 0, 0}, {-1, 1, 0}, {0, 1, 0}, {1, 1, 0},
+        {-1, -1, 1}, {0, -1, 1}, {1, -1, 1}, {-1, 0, 1}, {0, 0, 1}, {1, 0, 1}, {-1, 1, 1}, {0, 1, 1}, {1, 1, 1}
+    };
+
+    int numLeaves = leafKeys.size();
+    for (int leaf = 0; leaf < numLeaves; leaf++) {
+        compare_leaves(leaf, leaf, pairs);
+
+        uint32_t cx, cy, cz;
+        mortonDecode(leafKeys[leaf], cx, cy, cz);
+
+        for (const auto& offset : offsets) {
+            int64_t nx = (int64_t)cx + offset[0];
+            int64_t ny = (int64_t)cy + offset[1];
+            int64_t nz = (int64_t)cz + offset[2];
+            if (nx < 0 || ny < 0 || nz < 0 || nx > MORTON_MAX || ny > MORTON_MAX || nz > MORTON_MAX) {
+                continue;
+            }
+
+            uint64_t key = mortonEncode(nx, ny, nz);
+            auto found = lower_bound(leafKeys.begin(), leafKeys.end(), key);
+            if (found != leafKeys.end() && *found == key) {
+                compare_leaves(leaf, found - leafKeys.begin(), pairs);
+            }
+        }
+    }
+}
+
+void LinearOctree::find_risky_debris(vector<SpaceDebris>& riskList) const {
+    vector<DebrisPair> pairs;
+    find_pairs(pairs);
+
+    risk_list_from_pairs(debris_list, pairs, riskList);
+}
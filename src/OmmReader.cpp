@@ -0,0 +1,678 @@
+/****************************************************************/
+/*                           OmmReader                          */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        KVN and CSV are read a line at a time and XML one     */
+/*        '>'-terminated piece at a time; numbers are parsed    */
+/*        in place in the read buffer, which always ends in a   */
+/*        NUL so strtod stops at the buffer's end.              */
+/*        Short decimals, nearly all of them, skip strtod:      */
+/*        one exact power-of-ten scaling rounds the same.       */
+/****************************************************************/
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "OmmReader.h"
+
+namespace {
+
+const size_t OMM_BUFFER_BYTES = 1 << 20;
+const size_t OMM_DETECT_BYTES = 4096;
+
+enum OmmField {
+    F_EPOCH, F_MEAN_MOTION, F_ECCENTRICITY, F_INCLINATION, F_RA_OF_ASC_NODE,
+    F_ARG_OF_PERICENTER, F_MEAN_ANOMALY, F_NORAD_CAT_ID,
+    F_BSTAR, F_MEAN_MOTION_DOT, F_MEAN_MOTION_DDOT, F_MEAN_ELEMENT_THEORY,
+    F_COUNT, F_NONE = -1
+};
+
+const char* FIELD_NAMES[F_COUNT] = {
+    "EPOCH", "MEAN_MOTION", "ECCENTRICITY", "INCLINATION", "RA_OF_ASC_NODE",
+    "ARG_OF_PERICENTER", "MEAN_ANOMALY", "NORAD_CAT_ID",
+    "BSTAR", "MEAN_MOTION_DOT", "MEAN_MOTION_DDOT", "MEAN_ELEMENT_THEORY"
+};
+
+// Everything up to and including NORAD_CAT_ID; the drag terms default to zero
+const unsigned REQUIRED_FIELDS = (1u << (F_NORAD_CAT_ID + 1)) - 1;
+
+// Most keys in a message are not needed; length and first letter leave at most one name
+// to compare
+OmmField lookupField(const char* key, size_t length) {
+    OmmField field = F_NONE;
+    switch (length) {
+        case 5:
+            field = key[0] == 'E' ? F_EPOCH : key[0] == 'B' ? F_BSTAR : F_NONE;
+            break;
+        case 11:
+            field = key[0] == 'M' ? F_MEAN_MOTION : key[0] == 'I' ? F_INCLINATION : F_NONE;
+            break;
+        case 12:
+            field = key[0] == 'E' ? F_ECCENTRICITY : key[0] == 'M' ? F_MEAN_ANOMALY : key[0] == 'N' ? F_NORAD_CAT_ID : F_NONE;
+            break;
+        case 14:
+            field = F_RA_OF_ASC_NODE;
+            break;
+        case 15:
+            field = F_MEAN_MOTION_DOT;
+            break;
+        case 16:
+            field = F_MEAN_MOTION_DDOT;
+            break;
+        case 17:
+            field = F_ARG_OF_PERICENTER;
+            break;
+        case 19:
+            field = F_MEAN_ELEMENT_THEORY;
+            break;
+        default:
+            break;
+    }
+
+    if (field != F_NONE && memcmp(key, FIELD_NAMES[field], length) == 0) {
+        return field;
+    }
+    return F_NONE;
+}
+
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+inline bool keyIs(const char* key, size_t length, const char* name) {
+    return strlen(name) == length && memcmp(key, name, length) == 0;
+}
+
+inline void trim(const char*& text, size_t& length) {
+    while (length > 0 && isBlank(text[0])) {
+        text++;
+        length--;
+    }
+    while (length > 0 && isBlank(text[length - 1])) {
+        length--;
+    }
+}
+
+// Exact powers of ten: a mantissa of at most 15 digits scaled by one of them is a single
+// correctly rounded operation, so the result matches strtod
+const double POWERS_OF_TEN[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// [sign]digits[.digits][e[sign]digits] with few enough digits for the exact path; false
+// for anything else, which is left to strtod
+bool parseDecimal(const char* text, size_t length, double& value) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < length && (text[i] == '-' || text[i] == '+')) {
+        negative = text[i] == '-';
+        i++;
+    }
+
+    uint64_t mantissa = 0;
+    int significant = 0;
+    int scale = 0;
+    bool anyDigit = false;
+    bool fraction = false;
+    for (; i < length; i++) {
+        char c = text[i];
+        if (c >= '0' && c <= '9') {
+            anyDigit = true;
+            if (mantissa != 0 || c != '0') {
+                significant++;
+            }
+            mantissa = mantissa * 10 + (c - '0');
+            scale -= fraction ? 1 : 0;
+        } else if (c == '.' && !fraction) {
+            fraction = true;
+        } else {
+            break;
+        }
+    }
+
+    if (i < length && (text[i] == 'e' || text[i] == 'E')) {
+        i++;
+        bool negativeExponent = false;
+        if (i < length && (text[i] == '-' || text[i] == '+')) {
+            negativeExponent = text[i] == '-';
+            i++;
+        }
+
+        int exponent = 0;
+        size_t first = i;
+        for (; i < length && text[i] >= '0' && text[i] <= '9' && exponent < 1000; i++) {
+            exponent = exponent * 10 + (text[i] - '0');
+        }
+        if (i == first) {
+            return false;
+        }
+        scale += negativeExponent ? -exponent : exponent;
+    }
+
+    if (i != length || !anyDigit || significant > 15 || scale < -22 || scale > 22) {
+        return false;
+    }
+
+    double magnitude = (double)mantissa;
+    magnitude = scale < 0 ? magnitude / POWERS_OF_TEN[-scale] : magnitude * POWERS_OF_TEN[scale];
+    value = negative ? -magnitude : magnitude;
+    return true;
+}
+
+// The value must be followed by a character strtod stops at, which the buffer guarantees
+bool parseNumber(const char* text, size_t length, double& value) {
+    if (length == 0) {
+        return false;
+    }
+    if (parseDecimal(text, length, value)) {
+        return true;
+    }
+
+    char* end;
+    value = strtod(text, &end);
+    return end == text + length;
+}
+
+bool parseDigits(const char* text, size_t length, int& value) {
+    value = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] < '0' || text[i] > '9') {
+            return false;
+        }
+        value = value * 10 + (text[i] - '0');
+    }
+    return length > 0;
+}
+
+// YYYY-MM-DDThh:mm:ss[.f][Z] or YYYY-DDDThh:mm:ss[.f][Z]; the time of day may be omitted
+bool parseEpoch(const char* text, size_t length, double& ds50) {
+    if (length > 0 && text[length - 1] == 'Z') {
+        length--;
+    }
+
+    int year, month = 0, day, hour = 0, minute = 0;
+    double second = 0.0;
+    size_t t;
+
+    if (length < 8 || text[4] != '-' || !parseDigits(text, 4, year)) {
+        return false;
+    }
+
+    if (length >= 10 && text[7] == '-') {
+        if (!parseDigits(text + 5, 2, month) || !parseDigits(text + 8, 2, day)) {
+            return false;
+        }
+        t = 10;
+    } else {
+        if (!parseDigits(text + 5, 3, day)) {
+            return false;
+        }
+        t = 8;
+    }
+
+    if (t < length) {
+        if (text[t] != 'T' || length < t + 9 || text[t + 3] != ':' || text[t + 6] != ':' ||
+            !parseDigits(text + t + 1, 2, hour) || !parseDigits(text + t + 4, 2, minute)) {
+            return false;
+        }
+
+        // Seconds run to the end of the value; strtod needs them copied out in case a 'Z' follows
+        size_t n = length - (t + 7);
+        if (!parseDecimal(text + t + 7, n, second)) {
+            char seconds[32];
+            if (n == 0 || n >= sizeof(seconds)) {
+                return false;
+            }
+            memcpy(seconds, text + t + 7, n);
+            seconds[n] = '\0';
+            if (!parseNumber(seconds, n, second)) {
+                return false;
+            }
+        }
+    }
+
+    if (month > 0) {
+        ds50 = calendarToDs50(year, month, day, hour, minute, second);
+    } else {
+        ds50 = calendarToDs50(year, 1, 1, 0, 0, 0.0) - 1.0 + day + (hour * 3600.0 + minute * 60.0 + second) / 86400.0;
+    }
+
+    return true;
+}
+
+bool parseNoradId(const char* text, size_t length, int& satNum) {
+    if (length == 5 && isupper((unsigned char)text[0])) {
+        return parseCatalogNumber(text, satNum);
+    }
+    return length <= 9 && parseDigits(text, length, satNum);
+}
+
+// One message being assembled
+struct OmmRecord {
+    unsigned seen = 0;
+    bool badValue = false;
+    const char* error = nullptr;
+    double value[F_COUNT];
+    int satNum = 0;
+
+    void reset() {
+        seen = 0;
+        badValue = false;
+        error = nullptr;
+    }
+
+    void set(OmmField field, const char* text, size_t length) {
+        trim(text, length);
+
+        // Quoted CSV values
+        if (length >= 2 && text[0] == '"' && text[length - 1] == '"') {
+            text++;
+            length -= 2;
+        }
+
+        bool ok = true;
+        switch (field) {
+            case F_EPOCH:
+                ok = parseEpoch(text, length, value[field]);
+                break;
+            case F_NORAD_CAT_ID:
+                ok = parseNoradId(text, length, satNum);
+                break;
+            case F_MEAN_ELEMENT_THEORY:
+                // SGP4-XP and other theories need a different propagator
+                if (!keyIs(text, length, "SGP4") && !keyIs(text, length, "SGP/SGP4")) {
+                    error = "mean element theory is not SGP4";
+                }
+                break;
+            default:
+                ok = parseNumber(text, length, value[field]);
+                break;
+        }
+
+        if (!ok && error == nullptr) {
+            error = FIELD_NAMES[field];
+            badValue = true;
+        }
+        seen |= 1u << field;
+    }
+
+    bool finish(TleElements& el, string& why) {
+        if (error != nullptr) {
+            why = badValue ? string("bad ") + error : error;
+            return false;
+        }
+        if ((seen & REQUIRED_FIELDS) != REQUIRED_FIELDS) {
+            why = "missing";
+            for (int f = 0; f < F_COUNT; f++) {
+                if ((REQUIRED_FIELDS & (1u << f)) && !(seen & (1u << f))) {
+                    why += string(" ") + FIELD_NAMES[f];
+                }
+            }
+            return false;
+        }
+
+        double bstar = (seen & (1u << F_BSTAR)) ? value[F_BSTAR] : 0.0;
+        double ndot = (seen & (1u << F_MEAN_MOTION_DOT)) ? value[F_MEAN_MOTION_DOT] : 0.0;
+        double nddot = (seen & (1u << F_MEAN_MOTION_DDOT)) ? value[F_MEAN_MOTION_DDOT] : 0.0;
+
+        el.satNum = satNum;
+        el.epochDs50UTC = value[F_EPOCH];
+        elementsFromTleUnits(value[F_MEAN_MOTION], ndot, nddot, bstar, value[F_INCLINATION],
+                             value[F_RA_OF_ASC_NODE], value[F_ECCENTRICITY], value[F_ARG_OF_PERICENTER],
+                             value[F_MEAN_ANOMALY], el);
+        return true;
+    }
+};
+
+// Hands out delimiter-terminated pieces of a file through one growing buffer
+class PieceReader {
+    public:
+    explicit PieceReader(FILE* file) : file(file), buffer(OMM_BUFFER_BYTES + 1) {}
+
+    // Next piece up to (not including) delim; the last piece may end at end of file
+    bool next(char delim, const char*& piece, size_t& length) {
+        while (true) {
+            const char* found = static_cast<const char*>(memchr(&buffer[start], delim, end - start));
+
+            if (found != nullptr) {
+                piece = &buffer[start];
+                length = found - piece;
+                start += length + 1;
+                return true;
+            }
+
+            if (eof) {
+                if (start == end) {
+                    return false;
+                }
+                piece = &buffer[start];
+                length = end - start;
+                start = end;
+                return true;
+            }
+
+            refill();
+        }
+    }
+
+    size_t bytesRead() const {return total;}
+
+    private:
+    void refill() {
+        // Keep the unfinished piece, and grow only when a single piece fills the buffer
+        memmove(&buffer[0], &buffer[start], end - start);
+        end -= start;
+        start = 0;
+
+        if (end == buffer.size() - 1) {
+            buffer.resize(buffer.size() * 2);
+        }
+
+        size_t got = fread(&buffer[end], 1, buffer.size() - 1 - end, file);
+        end += got;
+        total += got;
+        buffer[end] = '\0';
+        eof = got == 0;
+    }
+
+    FILE* file;
+    vector<char> buffer;
+    size_t start = 0;
+    size_t end = 0;
+    size_t total = 0;
+    bool eof = false;
+};
+
+struct OmmSink {
+    vector<TleElements>& elements;
+    OmmReadStats& stats;
+    const CatalogFilter* filter;
+
+    void emit(OmmRecord& record) {
+        TleElements el;
+        string why;
+
+        if (record.finish(el, why)) {
+            if (filter == nullptr || filter->accepts(el)) {
+                elements.push_back(el);
+                stats.sets++;
+            } else {
+                stats.filtered++;
+            }
+        } else {
+            if (stats.rejected == 0) {
+                stats.firstError = why;
+            }
+            stats.rejected++;
+        }
+        record.reset();
+    }
+};
+
+void readKvn(PieceReader& reader, OmmSink& sink) {
+    OmmRecord record;
+    const char* line;
+    size_t length;
+
+    while (reader.next('\n', line, length)) {
+        // "KEY = value"; the key ends at the first blank or '='
+        size_t i = 0;
+        while (i < length && isBlank(line[i])) {
+            i++;
+        }
+        const char* key = line + i;
+        while (i < length && line[i] != '=' && !isBlank(line[i])) {
+            i++;
+        }
+        size_t keyLength = line + i - key;
+        while (i < length && isBlank(line[i])) {
+            i++;
+        }
+        if (i == length || line[i] != '=') {
+            continue;
+        }
+
+        OmmField field = lookupField(key, keyLength);
+        if (field == F_NONE) {
+            // Every message opens with its version line
+            if (keyIs(key, keyLength, "CCSDS_OMM_VERS") && record.seen != 0) {
+                sink.emit(record);
+            }
+            continue;
+        }
+
+        const char* value = line + i + 1;
+        size_t valueLength = length - i - 1;
+
+        // Optional units: "MEAN_MOTION = 15.5 [rev/day]"
+        const char* units = static_cast<const char*>(memchr(value, '[', valueLength));
+        if (units != nullptr) {
+            valueLength = units - value;
+        }
+
+        record.set(field, value, valueLength);
+    }
+
+    if (record.seen != 0) {
+        sink.emit(record);
+    }
+}
+
+void readCsv(PieceReader& reader, OmmSink& sink) {
+    vector<OmmField> columns;
+    OmmRecord record;
+    const char* line;
+    size_t length;
+
+    while (reader.next('\n', line, length)) {
+        if (length > 0 && line[length - 1] == '\r') {
+            length--;
+        }
+        if (length == 0) {
+            continue;
+        }
+
+        bool header = columns.empty();
+        int column = 0;
+        size_t i = 0;
+
+        while (i <= length) {
+            // Quoted fields may contain commas
+            size_t fieldStart = i;
+            if (i < length && line[i] == '"') {
+                i++;
+                while (i < length && !(line[i] == '"' && (i + 1 == length || line[i + 1] != '"'))) {
+                    i += (line[i] == '"') ? 2 : 1;
+                }
+                i++;
+            }
+            while (i < length && line[i] != ',') {
+                i++;
+            }
+
+            const char* text = line + fieldStart;
+            size_t textLength = i - fieldStart;
+
+            if (header) {
+                trim(text, textLength);
+                if (textLength >= 2 && text[0] == '"') {
+                    text++;
+                    textLength -= 2;
+                }
+                columns.push_back(lookupField(text, textLength));
+            } else if (column < (int)columns.size() && columns[column] != F_NONE) {
+                record.set(columns[column], text, textLength);
+            }
+
+            column++;
+            i++;
+        }
+
+        if (!header) {
+            sink.emit(record);
+        }
+    }
+}
+
+void readXml(PieceReader& reader, OmmSink& sink) {
+    OmmRecord record;
+    bool inComment = false;
+    const char* piece;
+    size_t length;
+
+    // Namespace prefix of the root element, with its ':'; the elements inside share it
+    string prefix;
+    bool rootSeen = false;
+
+    // Each piece is "[text]<tag ..." up to the next '>'
+    while (reader.next('>', piece, length)) {
+        if (inComment) {
+            inComment = !(length >= 2 && piece[length - 2] == '-' && piece[length - 1] == '-');
+            continue;
+        }
+
+        const char* open = static_cast<const char*>(memchr(piece, '<', length));
+        if (open == nullptr) {
+            continue;
+        }
+
+        const char* tag = open + 1;
+        size_t tagLength = piece + length - tag;
+
+        if (tagLength >= 3 && memcmp(tag, "!--", 3) == 0) {
+            inComment = !(tagLength >= 5 && tag[tagLength - 2] == '-' && tag[tagLength - 1] == '-');
+            continue;
+        }
+        if (tagLength == 0 || tag[0] == '?' || tag[0] == '!') {
+            continue;
+        }
+
+        bool closing = tag[0] == '/';
+        if (closing) {
+            tag++;
+            tagLength--;
+        } else if (!rootSeen) {
+            size_t nameLength = 0;
+            while (nameLength < tagLength && !isBlank(tag[nameLength]) && tag[nameLength] != '/') {
+                nameLength++;
+            }
+            const char* colon = static_cast<const char*>(memchr(tag, ':', nameLength));
+            prefix.assign(tag, colon != nullptr ? colon + 1 - tag : 0);
+            rootSeen = true;
+        }
+
+        if (!prefix.empty() && tagLength >= prefix.size() && memcmp(tag, prefix.data(), prefix.size()) == 0) {
+            tag += prefix.size();
+            tagLength -= prefix.size();
+        }
+
+        // Only <omm> opens anything of interest
+        if (!closing) {
+            if (tagLength >= 3 && memcmp(tag, "omm", 3) == 0 && (tagLength == 3 || isBlank(tag[3]) || tag[3] == '/')) {
+                record.reset();
+            }
+            continue;
+        }
+
+        // Closing tags have no attributes, at most blanks before the '>'
+        while (tagLength > 0 && isBlank(tag[tagLength - 1])) {
+            tagLength--;
+        }
+
+        if (keyIs(tag, tagLength, "omm")) {
+            sink.emit(record);
+            continue;
+        }
+
+        // A leaf's text is what precedes its closing tag; closing tags with none end containers
+        if (open != piece) {
+            OmmField field = lookupField(tag, tagLength);
+            if (field != F_NONE) {
+                record.set(field, piece, open - piece);
+            }
+        }
+    }
+}
+
+} // namespace
+
+OmmFormat detectOmmFormat(const char* head, size_t length) {
+    size_t i = 0;
+
+    // UTF-8 byte order mark and leading blank space
+    if (length >= 3 && (unsigned char)head[0] == 0xEF && (unsigned char)head[1] == 0xBB && (unsigned char)head[2] == 0xBF) {
+        i = 3;
+    }
+    while (i < length && isspace((unsigned char)head[i])) {
+        i++;
+    }
+    if (i == length) {
+        return OMM_NONE;
+    }
+
+    string text(head + i, length - i);
+
+    if (text[0] == '<') {
+        return text.find("omm") != string::npos || text.find("OMM") != string::npos ? OMM_XML : OMM_NONE;
+    }
+
+    // CSV headers usually name CCSDS_OMM_VERS as well, so check for one first
+    string firstLine = text.substr(0, text.find('\n'));
+    if (firstLine.find(',') != string::npos && firstLine.find("NORAD_CAT_ID") != string::npos) {
+        return OMM_CSV;
+    }
+    if (text.find("CCSDS_OMM_VERS") != string::npos) {
+        return OMM_KVN;
+    }
+
+    return OMM_NONE;
+}
+
+OmmFormat detectOmmFile(const char* fileName) {
+    FILE* file = fopen(fileName, "rb");
+    if (file == nullptr) {
+        return OMM_NONE;
+    }
+
+    char head[OMM_DETECT_BYTES];
+    size_t length = fread(head, 1, sizeof(head), file);
+    fclose(file);
+
+    return detectOmmFormat(head, length);
+}
+
+OmmReadStats readOmmFile(const char* fileName, OmmFormat format, vector<TleElements>& elements,
+                         const CatalogFilter* filter) {
+    OmmReadStats stats;
+
+    FILE* file = fopen(fileName, "rb");
+    if (file == nullptr) {
+        stats.firstError = "unable to open file";
+        return stats;
+    }
+
+    PieceReader reader(file);
+    OmmSink sink{elements, stats, filter};
+
+    switch (format) {
+        case OMM_KVN:
+            readKvn(reader, sink);
+            break;
+        case OMM_CSV:
+            readCsv(reader, sink);
+            break;
+        case OMM_XML:
+            readXml(reader, sink);
+            break;
+        default:
+            break;
+    }
+
+    stats.bytes = reader.bytesRead();
+    fclose(file);
+
+    return stats;
+}
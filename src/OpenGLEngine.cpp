@@ -74,14 +74,30 @@ OpenGLEngine::OpenGLEngine() {
     sunAngle = new float(0.0f);
     tolerance = new float(0.001f);
     iterations = new int(1);
+    ephemerisTolerance = new float(0.1f);
+    adaptiveTolerance = new float(0.5f);
+    shellPad = new float(10.0f);
+    windowHours = new float(6.0f);
+    windowStep = new float(1.0f);
 
     selectedPoint = nullptr;
 }
 
+bool OpenGLEngine::setCatalogFilter(const char* expression) {
+    string error;
+    if (!tle.setFilter(expression, error)) {
+        std::cout << "[ERROR]: Catalog filter: " << error << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
 // Initialize OpenGL
 void OpenGLEngine::init() {
     initSharedMem();
 
+    StartupProfiler::Phase windowPhase(PROFILE_STARTUP ? &profiler : nullptr, "Create window");
     if (!glfwInit())
         exit(EXIT_FAILURE);
  
@@ -102,17 +118,59 @@ void OpenGLEngine::init() {
     glfwMakeContextCurrent(window);
     gladLoadGL(glfwGetProcAddress);
     glfwSetWindowUserPointer(window, this);
+    windowPhase.stop();
  
     // Read TLE Data
-    points = tle.ReadFiles(numSats, epoch, debris);
+    tle.setBenchmarkBackends(BENCHMARK_BACKENDS);
+    tle.setProfiler(PROFILE_STARTUP ? &profiler : nullptr);
+    {
+        StartupProfiler::Phase phase(PROFILE_STARTUP ? &profiler : nullptr, "Read catalog");
+        points = tle.ReadFiles(numSats, epoch, debris);
+        phase.setCount(numSats);
+    }
+
+    // With lazy initialization the catalog services start on the producer thread once the
+    // last batch is published; until then frames are propagated directly
+    ephemeris.setToleranceKm(*ephemerisTolerance);
+    catalogReady = false;
+    startupPending.store(tle.isInitializing() ? 2 : 1);
+    if (tle.isNativeSgp4() && !tle.isInitializing()) {
+        startCatalogServices(epoch);
+    }
+
+    // Propagate on the producer thread; frames come back through the triple buffer
+    pipeline.start(numSats, points, [this](double time, GLfloat* out) {
+        updateHistory(time);
+
+        if (!catalogReady && tle.isNativeSgp4() && !tle.isInitializing()) {
+            startCatalogServices(time);
+            finishStartup();
+        }
+
+        if (!ephemerisActive.load() || !tle.isNativeSgp4() || !ephemeris.evaluate(time, out, tle.getKmPerUnit())) {
+            tle.propagate(time, out, numSats, false, producerDebris);
+            framePropagated.store(tle.getPropagatedCount());
+        } else {
+            framePropagated.store(0);
+        }
+    });
 
     // Initialize epoch
     newTime = doubleToDate(epoch);
 
     // Initialize graphics
+    StartupProfiler::Phase glPhase(PROFILE_STARTUP ? &profiler : nullptr, "initGL");
     initGL();
+    glPhase.stop();
+
+    StartupProfiler::Phase glslPhase(PROFILE_STARTUP ? &profiler : nullptr, "initGLSL");
     initGLSL();
+    glslPhase.stop();
+
+    StartupProfiler::Phase vboPhase(PROFILE_STARTUP ? &profiler : nullptr, "initVBO");
     initVBO();
+    vboPhase.setCount(numSats);
+    vboPhase.stop();
 
     // Load font
     // bmFont.loadFont(fontCourier20, bitmapCourier20);
@@ -127,7 +185,9 @@ void OpenGLEngine::init() {
 
 
     // Load Earth texture
+    StartupProfiler::Phase texturePhase(PROFILE_STARTUP ? &profiler : nullptr, "loadTexture");
     texId = loadTexture("earth2048.bmp", true);
+    texturePhase.stop();
 
     // Calculate perspective matrix projection
     toPerspective();
@@ -139,17 +199,116 @@ void OpenGLEngine::init() {
     std::cout << "OpenGL version supported: " << version << std::endl;
 
     // Initialize ImGui
+    StartupProfiler::Phase imguiPhase(PROFILE_STARTUP ? &profiler : nullptr, "ImGui");
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO(); (void)io;
     ImGui::StyleColorsDark();
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 330");
+    imguiPhase.stop();
 
     glfwSwapInterval(1);
+
+    finishStartup();
+}
+
+// Print the startup profile once init() has returned and, with lazy initialization, the
+// whole catalog is ready; whichever happens last prints it
+void OpenGLEngine::finishStartup() {
+    if (--startupPending == 0 && PROFILE_STARTUP) {
+        profiler.finish();
+    }
+}
+
+// Fit the first ephemeris window in the background and watch the TLE files; both need
+// every object initialized
+void OpenGLEngine::startCatalogServices(double time) {
+    vector<Sgp4Sat> sats;
+    vector<int> slots;
+    tle.getNativeCatalog(sats, slots);
+
+    ephemeris.setThreadPool(tle.getThreadPool());
+    ephemeris.setCatalog(sats, slots);
+    ephemeris.request(time);
+
+    if (WATCH_TLE_FILES) {
+        tle.startWatching();
+    }
+
+    catalogReady = true;
+}
+
+void OpenGLEngine::updateHistory(double time) {
+    // Newly initialized objects, reloaded objects and objects that moved to a closer-epoch
+    // element set are swapped in before the frame is propagated, and reach the cache at
+    // its next refit
+    vector<int> switchedSlots;
+    vector<Sgp4Sat> switchedSats;
+    if (tle.updateHistory(time, switchedSlots, switchedSats) > 0) {
+        ephemeris.updateSatellites(switchedSlots, switchedSats);
+    }
+}
+
+void OpenGLEngine::screenWindowJob(double start, double stepMinutes, int numSteps, double padKm, double toleranceKm) {
+    cout << "Screening " << numSteps << " steps of " << stepMinutes << " min..." << endl;
+    cout << "Tolerance: " << toleranceKm << " km" << endl;
+
+    // Shells first, so only objects in a candidate pair are propagated
+    vector<TleElements> elements;
+    tle.getCatalogElements(elements);
+
+    OrbitShellFilter shells;
+    shells.build(elements, padKm, tle.getThreadPool());
+
+    vector<int> slots;
+    shells.involvedObjects(slots);
+    cout << "Propagating " << slots.size() << " of " << elements.size() << " objects" << endl;
+
+    if (screeningCancel.load()) {
+        return;
+    }
+
+    // Native SGP4 propagates from its own context alongside the producer; the DLL path
+    // serializes on the Astro Standards lock instead
+    EphemerisTable table;
+    tle.generateEphemeris(table, slots, start, stepMinutes, numSteps, EPHEM_SAT_MAJOR);
+
+    vector<Conjunction> conjunctions;
+    screenWindow(table, slots, shells, toleranceKm, conjunctions, tle.getThreadPool(), &screeningCancel);
+    if (screeningCancel.load()) {
+        return;
+    }
+    cout << conjunctions.size() << " conjunctions within tolerance" << endl;
+
+    // Listed at the window start, where the paused view is
+    double kmPerUnit = tle.getKmPerUnit();
+    vector<SpaceDebris> windowDebris(elements.size(), SpaceDebris(0, 0.0, 0.0, 0.0));
+    for (int row = 0; row < (int)slots.size(); row++) {
+        const double* pos = table.position(row, 0);
+        windowDebris[slots[row]] = SpaceDebris(elements[slots[row]].satNum, pos[0] / kmPerUnit, pos[2] / kmPerUnit, pos[1] / kmPerUnit);
+    }
+
+    vector<DebrisPair> pairs;
+    for (const Conjunction& conjunction : conjunctions) {
+        pairs.push_back(DebrisPair{conjunction.first, conjunction.second, conjunction.missKm / kmPerUnit});
+    }
+
+    screeningResult.clear();
+    risk_list_from_pairs(windowDebris, pairs, screeningResult);
+    screeningDone.store(true);
 }
 
 void OpenGLEngine::shutdown() {
+    // A running screening job stops after its current stage
+    screeningCancel.store(true);
+    if (screeningThread.joinable()) {
+        screeningThread.join();
+    }
+
+    tle.stopWatching();
+    pipeline.stop();
+
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -207,7 +366,15 @@ bool OpenGLEngine::initSharedMem()
 
     drawMode = 0;
 
-    algorithmSelection = 0;
+    algorithmSelection = RISK_OCTREE;
+
+    useEphemeris = true;
+    ephemerisActive.store(true);
+    useAdaptive = false;
+    framePropagated.store(0);
+
+    screeningDone.store(false);
+    screeningCancel.store(false);
 
     vao = 0;
     pointsVao = 0;
@@ -390,6 +557,9 @@ void OpenGLEngine::initVBO()
 
 void OpenGLEngine::clearSharedMem()
 {
+    // The producer must be idle before anything it touches goes away
+    pipeline.stop();
+
     // Clean up Earth
     glDeleteBuffers(1, &vbo);
     glDeleteBuffers(1, &ibo);
@@ -409,10 +579,13 @@ void OpenGLEngine::clearSharedMem()
     delete sunAngle;
     delete tolerance;
     delete iterations;
+    delete ephemerisTolerance;
+    delete adaptiveTolerance;
+    delete shellPad;
+    delete windowHours;
+    delete windowStep;
 
-    if (points != nullptr) {
-        delete[] points;
-    }
+    TLEReader::freePoints(points);
 
     if (riskyPoints != nullptr) {
         delete[] riskyPoints;
@@ -567,7 +740,19 @@ void OpenGLEngine::toPerspective()
 void OpenGLEngine::preFrame(double frameTime)
 {
     if (!isPaused) {
-        tle.propagate(epoch + totalTime / (86400.0), points, numSats, false, debris);
+        double now = epoch + totalTime / (86400.0);
+
+        // Fit about 30 seconds of wall time ahead at the current speed
+        double windowDays = 30.0 * pow(10, simSpeed) / 86400.0;
+        ephemeris.setWindowDays(min(max(windowDays, 10.0 / 1440.0), 1.0));
+
+        ephemerisActive.store(useEphemeris);
+        tle.setAdaptiveUpdates(useAdaptive);
+        tle.setSimSecondsPerFrame(frameTime * pow(10, simSpeed));
+        pipeline.request(now);
+    } else if (tle.hasStagedUpdates()) {
+        // Paused: still bring in objects that finished initializing or were reloaded
+        pipeline.request(epoch + totalTime / (86400.0));
     }
 }
 
@@ -630,9 +815,12 @@ void OpenGLEngine::frame(double frameTime)
     glDrawElements(GL_TRIANGLES, earth.getIndexCount(), GL_UNSIGNED_INT, (void*)0);
     glBindVertexArray(0);
 
-    // Draw Points
+    // Draw Points; upload only when the producer has finished a newer frame
     glBindBuffer(GL_ARRAY_BUFFER, pointsVbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, numSats * 3 * sizeof(GLfloat), points);
+    const GLfloat* latest = pipeline.acquire();
+    if (latest != nullptr) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, numSats * 3 * sizeof(GLfloat), latest);
+    }
     glUniform1i(glGetUniformLocation(progId, "isPoint"), GL_TRUE);
     glPointSize(3);
     glBindVertexArray(pointsVao);
@@ -726,7 +914,11 @@ void OpenGLEngine::frame(double frameTime)
 
             epoch = dateToDouble(newTime);
 
-            tle.propagate(epoch, points, numSats, false, debris);
+            // A jump inside the fitted window is answered from it; otherwise fit one there
+            if (!ephemeris.covers(epoch)) {
+                ephemeris.request(epoch);
+            }
+            pipeline.request(epoch);
         } catch (std::invalid_argument) {
             isValid = false;
         }
@@ -766,58 +958,166 @@ void OpenGLEngine::frame(double frameTime)
         simSpeed++; 
     }
 
+    // Propagation backend
+    if (tle.getBackendCount() > 1) {
+        int selected = tle.getBackendIndex();
+        if (ImGui::BeginCombo("Propagator", tle.getBackendName(selected))) {
+            for (int i = 0; i < tle.getBackendCount(); i++) {
+                string label = tle.getBackendName(i);
+                if (tle.getBackendMs(i) >= 0.0) {
+                    ostringstream ossMs;
+                    ossMs << std::fixed << std::setprecision(2) << tle.getBackendMs(i);
+                    label += " (" + ossMs.str() + " ms)";
+                }
+
+                if (ImGui::Selectable(label.c_str(), i == selected)) {
+                    pipeline.runExclusive([&] {
+                        tle.selectBackend(i);
+                    });
+                }
+            }
+            ImGui::EndCombo();
+        }
+    }
+
+    // Adaptive update rates
+    ImGui::Checkbox("Adaptive Updates", &useAdaptive);
+    if (ImGui::SliderFloat("Adaptive Tolerance (km)", adaptiveTolerance, 0.01f, 10.0f, "%.2f", ImGuiSliderFlags_Logarithmic)) {
+        tle.setAdaptiveToleranceKm(*adaptiveTolerance);
+    }
+    ImGui::Text("Propagated last frame: %d / %d", framePropagated.load(), numSats);
+    if (useAdaptive) {
+        ImGui::Text("Due every frame: %d", tle.getEveryFrameCount());
+    }
+
+    // Lazy initialization progress; quarantined sets are listed in quarantine.txt
+    int numQuarantined = tle.getQuarantinedCount();
+    if (tle.isInitializing()) {
+        ImGui::Text("Initializing: %d / %d ready", numSats - tle.getPendingCount(), numSats);
+    }
+    if (numQuarantined > 0) {
+        ImGui::Text("Quarantined element sets: %d", numQuarantined);
+    }
+
+    // Ephemeris cache
+    ImGui::Checkbox("Ephemeris Cache", &useEphemeris);
+    if (ImGui::SliderFloat("Cache Tolerance (km)", ephemerisTolerance, 0.001f, 10.0f, "%.3f", ImGuiSliderFlags_Logarithmic)) {
+        ephemeris.setToleranceKm(*ephemerisTolerance);
+    }
+    EphemerisStats ephemerisStats = ephemeris.getStats();
+    ImGui::Text("Cache hits: %llu  misses: %llu  refits: %llu", ephemerisStats.hits, ephemerisStats.misses, ephemerisStats.refits);
+    ImGui::Text("Fit error: %.4f km  fit time: %.2f s", ephemerisStats.maxErrorKm, ephemerisStats.lastFitSeconds);
+    double fittedDays = ephemerisStats.windowEnd - ephemerisStats.windowStart;
+    ImGui::Text("Window: %.1f min%s  segments: %lld  coefficients: %.1f MB", fittedDays * 1440.0,
+                fittedDays < ephemerisStats.requestedDays - 1.0e-9 ? " (capped)" : "", ephemerisStats.segments, ephemerisStats.coeffMb);
+
     ImGui::Text("Select Risk Detection Algorithm");
     ImGui::RadioButton("Octree", &algorithmSelection, 0); 
     ImGui::SameLine();
     ImGui::RadioButton("Iterative", &algorithmSelection, 1);
     ImGui::SameLine();
+    ImGui::RadioButton("Hash Grid", &algorithmSelection, 2);
+    ImGui::SameLine();
+    ImGui::RadioButton("k-d Tree", &algorithmSelection, 3);
+    ImGui::SameLine();
+    ImGui::RadioButton("Sort and Sweep", &algorithmSelection, 4);
+    ImGui::SameLine();
     ImGui::SetNextItemWidth(100);
     ImGui::InputInt("Iterations", iterations);
     ImGui::Text("Tolerance (Distance between risky nodes):");
     ImGui::SliderFloat("Tolerance", this->tolerance, 0.00001f, 0.1f, "%.5f");
+    bool riskUpdated = false;
     if (ImGui::Button("Run")) {
         // Run selected algorithm at current time
+        riskUpdated = true;
         isPaused = true;
         debris.clear();
 
-        tle.propagate(epoch + totalTime / (86400.0), points, numSats, true, debris);
+        double now = epoch + totalTime / (86400.0);
+        pipeline.runExclusive([&] {
+            updateHistory(now);
+            tle.propagate(now, points, numSats, true, debris);
+        });
+        pipeline.request(now);
         
-        if (algorithmSelection == 1) {
+        riskList.clear();
+        delete[] riskyPoints;
+
+        if (algorithmSelection == RISK_ITERATIVE) {
             cout << "Running iterative algorithm..." << endl;
             cout << "Tolerance: " << *tolerance << endl;
 
-            riskList.clear();
-            delete[] riskyPoints;
-
-            SpaceDebris start(-1, 0, 0, 0);
             riskList = find_local_optimum(debris, *tolerance, *iterations);
-            numRisky = riskList.size();
+        } else if (algorithmSelection == RISK_HASH_GRID) {
+            cout << "Running hash grid algorithm..." << endl;
+            cout << "Tolerance: " << *tolerance << endl;
+
+            SpatialHashGrid grid(debris, *tolerance);
+            grid.find_risky_debris(riskList);
+        } else if (algorithmSelection == RISK_KD_TREE) {
+            cout << "Running k-d tree algorithm..." << endl;
+            cout << "Tolerance: " << *tolerance << endl;
 
-            riskyPoints = new GLfloat[riskList.size() * 3];
+            // Every listed object shows its true nearest neighbour
+            KdTree tree(debris, tle.getThreadPool());
+            tree.find_risky_debris(*tolerance, riskList);
+        } else if (algorithmSelection == RISK_SORT_AND_SWEEP) {
+            cout << "Running sort and sweep algorithm..." << endl;
+            cout << "Tolerance: " << *tolerance << endl;
 
-            for (int i = 0; i < riskList.size(); i++) {
-                riskyPoints[i * 3] = riskList.at(i).x;
-                riskyPoints[i * 3 + 1] = riskList.at(i).y;
-                riskyPoints[i * 3 + 2] = riskList.at(i).z;
-            } 
+            SortAndSweep sweep(debris, *tolerance, tle.getThreadPool());
+            sweep.find_risky_debris(riskList);
         } else {
             cout << "Running octree algorithm..." << endl;
             cout << "Tolerance: " << *tolerance << endl;
 
+            LinearOctree otree(debris, *tolerance);
+            otree.find_risky_debris(riskList);
+        }
+    }
+
+    // Closest approaches over a window, among objects whose altitude shells overlap
+    ImGui::Text("Window screening (closest approach within the tolerance above):");
+    ImGui::SetNextItemWidth(100);
+    ImGui::InputFloat("Hours", windowHours);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(100);
+    ImGui::InputFloat("Step (min)", windowStep);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(100);
+    ImGui::InputFloat("Shell Pad (km)", shellPad);
+    if (screeningThread.joinable()) {
+        if (screeningDone.load()) {
+            screeningThread.join();
+            screeningDone.store(false);
+
+            riskUpdated = true;
             riskList.clear();
             delete[] riskyPoints;
+            riskList.swap(screeningResult);
+        } else {
+            ImGui::Text("Screening...");
+        }
+    } else if (ImGui::Button("Screen Window") && *windowHours > 0.0f && *windowStep > 0.0f) {
+        isPaused = true;
 
-            Octree otree(debris, *tolerance);
-            otree.find_risky_debris(riskList);
-            numRisky = riskList.size();
+        double now = epoch + totalTime / (86400.0);
+        int numSteps = (int)(*windowHours * 60.0f / *windowStep) + 1;
+        pipeline.request(now);
+
+        screeningThread = thread(&OpenGLEngine::screenWindowJob, this, now, (double)*windowStep, numSteps,
+                                 (double)*shellPad, *tolerance * tle.getKmPerUnit());
+    }
+
+    if (riskUpdated) {
+        numRisky = riskList.size();
 
-            riskyPoints = new GLfloat[riskList.size() * 3];
+        riskyPoints = new GLfloat[riskList.size() * 3];
 
-            for (int i = 0; i < riskList.size(); i++) {
-                riskyPoints[i * 3] = riskList.at(i).x;
-                riskyPoints[i * 3 + 1] = riskList.at(i).y;
-                riskyPoints[i * 3 + 2] = riskList.at(i).z;
-            } 
+        for (int i = 0; i < riskList.size(); i++) {
+            riskyPoints[i * 3] = riskList.at(i).x;
+            riskyPoints[i * 3 + 1] = riskList.at(i).y;
+            riskyPoints[i * 3 + 2] = riskList.at(i).z;
         }
     }
 
@@ -0,0 +1,111 @@
+/****************************************************************/
+/*                        OrbitShellFilter                      */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        Sorting by lower bound makes every object's later     */
+/*        overlaps contiguous: they are the objects whose       */
+/*        lower bound is at most its upper bound. Each window   */
+/*        end is one binary search, so the build is             */
+/*        O(n log n) however many pairs survive.                */
+/****************************************************************/
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#include "OrbitShellFilter.h"
+#include "RadixSort.h"
+
+namespace {
+
+// Objects per window search task
+const int SHELL_CHUNK = 4096;
+
+} // namespace
+
+void OrbitShellFilter::build(const vector<TleElements>& elements, double padKm, ThreadPool* pool) {
+    this->padKm = padKm;
+    int n = elements.size();
+
+    low.resize(n);
+    high.resize(n);
+
+    vector<uint64_t> keys(n);
+    order.resize(n);
+    for (int i = 0; i < n; i++) {
+        double perigee, apogee;
+        meanAltitudes(elements[i], perigee, apogee);
+
+        low[i] = perigee - padKm;
+        high[i] = apogee + padKm;
+        keys[i] = sortableKey(low[i]);
+        order[i] = i;
+    }
+
+    radixSort(keys, order, pool);
+
+    vector<double> sortedLow(n);
+    for (int k = 0; k < n; k++) {
+        sortedLow[k] = low[order[k]];
+    }
+
+    windowEnds.resize(n);
+    int numChunks = (n + SHELL_CHUNK - 1) / SHELL_CHUNK;
+    vector<long long> chunkCandidates(numChunks, 0);
+
+    auto task = [&](int c) {
+        int end = min(n, (c + 1) * SHELL_CHUNK);
+        for (int k = c * SHELL_CHUNK; k < end; k++) {
+            int windowEnd = upper_bound(sortedLow.begin() + k + 1, sortedLow.end(), high[order[k]]) - sortedLow.begin();
+            windowEnds[k] = windowEnd;
+            chunkCandidates[c] += windowEnd - k - 1;
+        }
+    };
+
+    if (pool != nullptr) {
+        pool->run(numChunks, task);
+    } else {
+        for (int c = 0; c < numChunks; c++) {
+            task(c);
+        }
+    }
+
+    numCandidates = 0;
+    for (long long count : chunkCandidates) {
+        numCandidates += count;
+    }
+
+    long long total = pairCount();
+    std::cout << "[Shells] " << numCandidates << " candidate pairs of " << total << " (pad " << std::fixed
+              << std::setprecision(1) << padKm << " km, " << (total > 0 ? 100.0 * (total - numCandidates) / total : 0.0)
+              << "% removed)" << std::defaultfloat << std::endl;
+}
+
+void OrbitShellFilter::candidates(int begin, int end, vector<pair<int, int>>& pairs) const {
+    for (int k = begin; k < end; k++) {
+        for (int m = k + 1; m < windowEnds[k]; m++) {
+            pairs.push_back(make_pair(order[k], order[m]));
+        }
+    }
+}
+
+void OrbitShellFilter::involvedObjects(vector<int>& objects) const {
+    objects.clear();
+
+    // Position k pairs with later positions if its window is not empty, and with an earlier
+    // one if some earlier window reaches past it
+    int reach = 0;
+    for (int k = 0; k < (int)order.size(); k++) {
+        if (windowEnds[k] > k + 1 || reach > k) {
+            objects.push_back(order[k]);
+        }
+        reach = max(reach, windowEnds[k]);
+    }
+
+    sort(objects.begin(), objects.end());
+}
+
+bool OrbitShellFilter::overlaps(int a, int b) const {
+    return low[a] <= high[b] && low[b] <= high[a];
+}
@@ -0,0 +1,186 @@
+/****************************************************************/
+/*                      PropagationBackend                      */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        Native and Astro Standards propagation backends.      */
+/*        The DLL backends need the Sgp4Prop library loaded     */
+/*        and every catalog key initialized with Sgp4InitSat.   */
+/*        The library keeps process-wide state, so every call   */
+/*        into it is serialized on one lock; the native         */
+/*        backend is reentrant and takes no lock.               */
+/****************************************************************/
+
+#include "PropagationBackend.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include "tle/Sgp4PropDll.h"
+#ifdef __cplusplus
+}
+#endif
+
+#include <mutex>
+
+namespace {
+
+// Guards every Astro Standards call: the DLL's satellite tables are global
+mutex astroStandardsLock;
+
+inline int propagateDs50Utc(__int64 satKey, double ds50UTC, double pos[3]) {
+    double mse, vel[3], llh[3];
+    return Sgp4PropDs50UTC(satKey, ds50UTC, &mse, pos, vel, llh);
+}
+
+// Entries with a DLL key; the rest are counted in numMissing
+vector<CatalogEntry> keyedEntries(const SatelliteCatalog& catalog, int& numMissing) {
+    vector<CatalogEntry> keyed;
+    numMissing = 0;
+
+    for (const CatalogEntry& entry : catalog) {
+        if (entry.satKey != 0) {
+            keyed.push_back(entry);
+        } else {
+            numMissing++;
+        }
+    }
+
+    return keyed;
+}
+
+inline void writePoint(GLfloat* points, int slot, const double pos[3], double kmPerUnit) {
+    points[slot * 3] = pos[0] / kmPerUnit;
+    points[slot * 3 + 1] = pos[2] / kmPerUnit;
+    points[slot * 3 + 2] = pos[1] / kmPerUnit;
+}
+
+} // namespace
+
+NativeBackend::NativeBackend(const vector<Sgp4Sat>& sats, ThreadPool* pool) : sats(sats), pool(pool) {
+    vector<int> slots(sats.size());
+    for (int i = 0; i < (int)sats.size(); i++) {
+        slots[i] = i;
+    }
+
+    batch.build(sats, slots, PROPAGATION_CHUNK_SLOTS);
+}
+
+void NativeBackend::propagateAll(double ds50UTC, GLfloat* points, double kmPerUnit) {
+    // Chunks own disjoint, cache-line aligned slot ranges, so the parallel
+    // result is identical to the serial one
+    if (pool != nullptr) {
+        pool->run(batch.chunkCount(), [&](int c) {
+            batch.propagateChunk(c, ds50UTC, points, kmPerUnit);
+        });
+    } else {
+        batch.propagate(ds50UTC, points, kmPerUnit);
+    }
+}
+
+int NativeBackend::position(const CatalogEntry& entry, double ds50UTC, double pos[3]) {
+    double vel[3];
+    return sgp4PropagateDs50(sats[entry.slot], ds50UTC, pos, vel);
+}
+
+void NativeBackend::replace(int slot, const Sgp4Sat& sat) {
+    replace(vector<int>(1, slot), vector<Sgp4Sat>(1, sat));
+}
+
+void NativeBackend::replace(const vector<int>& slots, const vector<Sgp4Sat>& newSats) {
+    bool rebuild = false;
+    for (int i = 0; i < (int)slots.size(); i++) {
+        sats[slots[i]] = newSats[i];
+
+        // Once a rebuild is due the remaining slots only need their record
+        if (!rebuild && !batch.replace(slots[i], newSats[i])) {
+            rebuild = true;
+        }
+    }
+
+    if (rebuild) {
+        vector<int> all(sats.size());
+        for (int i = 0; i < (int)sats.size(); i++) {
+            all[i] = i;
+        }
+
+        batch.build(sats, all, PROPAGATION_CHUNK_SLOTS);
+    }
+}
+
+Ds50UtcBackend::Ds50UtcBackend(const SatelliteCatalog& catalog) {
+    entries = keyedEntries(catalog, numMissing);
+}
+
+void Ds50UtcBackend::propagateAll(double ds50UTC, GLfloat* points, double kmPerUnit) {
+    lock_guard<mutex> guard(astroStandardsLock);
+    double pos[3];
+    for (const CatalogEntry& entry : entries) {
+        propagateDs50Utc(entry.satKey, ds50UTC, pos);
+        writePoint(points, entry.slot, pos, kmPerUnit);
+    }
+}
+
+int Ds50UtcBackend::position(const CatalogEntry& entry, double ds50UTC, double pos[3]) {
+    if (entry.satKey == 0) {
+        return BACKEND_ERR_NO_KEY;
+    }
+
+    lock_guard<mutex> guard(astroStandardsLock);
+    return propagateDs50Utc(entry.satKey, ds50UTC, pos);
+}
+
+Ds50UtcPosBackend::Ds50UtcPosBackend(const SatelliteCatalog& catalog) {
+    entries = keyedEntries(catalog, numMissing);
+}
+
+void Ds50UtcPosBackend::propagateAll(double ds50UTC, GLfloat* points, double kmPerUnit) {
+    lock_guard<mutex> guard(astroStandardsLock);
+    double pos[3];
+    for (const CatalogEntry& entry : entries) {
+        Sgp4PropDs50UtcPos(entry.satKey, ds50UTC, pos);
+        writePoint(points, entry.slot, pos, kmPerUnit);
+    }
+}
+
+int Ds50UtcPosBackend::position(const CatalogEntry& entry, double ds50UTC, double pos[3]) {
+    if (entry.satKey == 0) {
+        return BACKEND_ERR_NO_KEY;
+    }
+
+    lock_guard<mutex> guard(astroStandardsLock);
+    return Sgp4PropDs50UtcPos(entry.satKey, ds50UTC, pos);
+}
+
+AllSatsBackend::AllSatsBackend(const SatelliteCatalog& catalog) {
+    for (const CatalogEntry& entry : keyedEntries(catalog, numMissing)) {
+        keys.push_back(entry.satKey);
+        slots.push_back(entry.slot);
+    }
+
+    ephem.resize(keys.size() * 6);
+}
+
+void AllSatsBackend::propagateAll(double ds50UTC, GLfloat* points, double kmPerUnit) {
+    if (keys.empty()) {
+        return;
+    }
+
+    // ephem is shared by every caller of this backend, so it stays under the lock too
+    lock_guard<mutex> guard(astroStandardsLock);
+    Sgp4PropAllSats(keys.data(), keys.size(), ds50UTC, reinterpret_cast<double(*)[6]>(ephem.data()));
+
+    for (int i = 0; i < (int)keys.size(); i++) {
+        writePoint(points, slots[i], &ephem[i * 6], kmPerUnit);
+    }
+}
+
+int AllSatsBackend::position(const CatalogEntry& entry, double ds50UTC, double pos[3]) {
+    if (entry.satKey == 0) {
+        return BACKEND_ERR_NO_KEY;
+    }
+
+    lock_guard<mutex> guard(astroStandardsLock);
+    return Sgp4PropDs50UtcPos(entry.satKey, ds50UTC, pos);
+}
@@ -0,0 +1,113 @@
+/****************************************************************/
+/*                      PropagationPipeline                     */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        Triple buffer: the producer owns the back frame, the  */
+/*        render thread owns the front frame, and the middle    */
+/*        frame is swapped through one atomic index. Publishing */
+/*        and acquiring are single exchanges; neither side      */
+/*        ever blocks on the other.                             */
+/****************************************************************/
+
+#include <algorithm>
+#include <chrono>
+
+#include "PropagationPipeline.h"
+#include "TLEReader.h"
+
+PropagationPipeline::~PropagationPipeline() {
+    stop();
+
+    for (int i = 0; i < 3; i++) {
+        TLEReader::freePoints(buffers[i]);
+    }
+}
+
+void PropagationPipeline::start(int numSats, const GLfloat* initial, Producer produceFn) {
+    stop();
+
+    for (int i = 0; i < 3; i++) {
+        TLEReader::freePoints(buffers[i]);
+        buffers[i] = TLEReader::allocatePoints(numSats);
+        copy(initial, initial + numSats * 3, buffers[i]);
+        times[i] = 0.0;
+    }
+
+    back = 0;
+    middle.store(1);
+    front = 2;
+    produceSeconds.store(0.0);
+
+    produce = produceFn;
+    stopping = false;
+    hasRequest = false;
+    producer = thread(&PropagationPipeline::producerLoop, this);
+}
+
+void PropagationPipeline::stop() {
+    if (producer.joinable()) {
+        {
+            lock_guard<mutex> guard(requestLock);
+            stopping = true;
+        }
+        wake.notify_one();
+        producer.join();
+    }
+}
+
+void PropagationPipeline::request(double ds50UTC) {
+    {
+        lock_guard<mutex> guard(requestLock);
+        requestedTime = ds50UTC;
+        hasRequest = true;
+    }
+    wake.notify_one();
+}
+
+const GLfloat* PropagationPipeline::acquire(double* ds50UTC) {
+    if (buffers[front] == nullptr || (middle.load(memory_order_acquire) & FRESH) == 0) {
+        return nullptr;
+    }
+
+    front = middle.exchange(front, memory_order_acq_rel) & INDEX_MASK;
+
+    if (ds50UTC != nullptr) {
+        *ds50UTC = times[front];
+    }
+    return buffers[front];
+}
+
+void PropagationPipeline::runExclusive(const function<void()>& fn) {
+    lock_guard<mutex> guard(produceLock);
+    fn();
+}
+
+void PropagationPipeline::producerLoop() {
+    while (true) {
+        double time;
+
+        {
+            unique_lock<mutex> guard(requestLock);
+            wake.wait(guard, [this] {return stopping || hasRequest;});
+
+            if (stopping) {
+                return;
+            }
+
+            time = requestedTime;
+            hasRequest = false;
+        }
+
+        auto began = chrono::steady_clock::now();
+        {
+            lock_guard<mutex> guard(produceLock);
+            produce(time, buffers[back]);
+        }
+        produceSeconds.store(chrono::duration<double>(chrono::steady_clock::now() - began).count());
+
+        // Publish the finished frame and take back whichever one the render thread is not using
+        times[back] = time;
+        back = middle.exchange(back | FRESH, memory_order_acq_rel) & INDEX_MASK;
+    }
+}
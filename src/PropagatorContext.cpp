@@ -0,0 +1,27 @@
+/****************************************************************/
+/*                       PropagatorContext                      */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        Thin reentrant wrapper over sgp4Propagate.            */
+/****************************************************************/
+
+#include "PropagatorContext.h"
+
+int PropagatorContext::propagate(int slot, double ds50UTC, double pos[3], double vel[3]) const {
+    return sgp4PropagateDs50((*sats)[slot], ds50UTC, pos, vel);
+}
+
+int PropagatorContext::propagateRange(int first, int last, double ds50UTC, double* xyz) const {
+    int failed = 0;
+    double vel[3];
+
+    for (int slot = first; slot < last; slot++) {
+        int error = propagate(slot, ds50UTC, &xyz[(slot - first) * 3], vel);
+        if (error != SGP4_OK && error != SGP4_ERR_DECAYED) {
+            failed++;
+        }
+    }
+
+    return failed;
+}
@@ -0,0 +1,99 @@
+/****************************************************************/
+/*                           RadixSort                          */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        Eight 8-bit passes ping-ponging between two buffers.  */
+/*        Each chunk counts its own keys, so every chunk can    */
+/*        scatter from its own offsets and the sort stays       */
+/*        stable across chunks.                                 */
+/****************************************************************/
+
+#include <algorithm>
+#include <cstring>
+
+#include "RadixSort.h"
+
+namespace {
+
+// Keys per chunk below which extra chunks cost more than they save
+const size_t RADIX_MIN_CHUNK = 1 << 16;
+
+} // namespace
+
+void radixSort(vector<uint64_t>& keys, vector<int>& values, ThreadPool* pool) {
+    const int passes = 8;
+    size_t n = keys.size();
+
+    size_t numChunks = 1;
+    if (pool != nullptr) {
+        numChunks = max<size_t>(1, min<size_t>(pool->size() * 4, n / RADIX_MIN_CHUNK));
+    }
+    size_t chunkSize = (n + numChunks - 1) / numChunks;
+
+    auto run = [&](const function<void(int)>& task) {
+        if (numChunks > 1) {
+            pool->run(numChunks, task);
+        } else {
+            task(0);
+        }
+    };
+
+    vector<uint64_t> keyScratch(n);
+    vector<int> valueScratch(n);
+    vector<size_t> counts(numChunks * 256);
+
+    for (int p = 0; p < passes; p++) {
+        int shift = p * 8;
+
+        fill(counts.begin(), counts.end(), 0);
+        run([&](int c) {
+            size_t* count = &counts[c * 256];
+            size_t end = min(n, (c + 1) * chunkSize);
+            for (size_t i = c * chunkSize; i < end; i++) {
+                count[(keys[i] >> shift) & 0xff]++;
+            }
+        });
+
+        // Every key has the same byte here; the order would not change
+        size_t first = n > 0 ? (keys[0] >> shift) & 0xff : 0;
+        size_t same = 0;
+        for (size_t c = 0; c < numChunks; c++) {
+            same += counts[c * 256 + first];
+        }
+        if (same == n) {
+            continue;
+        }
+
+        // Bucket-major, chunk-minor offsets keep equal bytes in their original order
+        size_t offset = 0;
+        for (int b = 0; b < 256; b++) {
+            for (size_t c = 0; c < numChunks; c++) {
+                size_t count = counts[c * 256 + b];
+                counts[c * 256 + b] = offset;
+                offset += count;
+            }
+        }
+
+        run([&](int c) {
+            size_t* next = &counts[c * 256];
+            size_t end = min(n, (c + 1) * chunkSize);
+            for (size_t i = c * chunkSize; i < end; i++) {
+                size_t dest = next[(keys[i] >> shift) & 0xff]++;
+                keyScratch[dest] = keys[i];
+                valueScratch[dest] = values[i];
+            }
+        });
+
+        keys.swap(keyScratch);
+        values.swap(valueScratch);
+    }
+}
+
+uint64_t sortableKey(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    // Negatives sort in reverse magnitude, and below every positive
+    return (bits >> 63) ? ~bits : bits | (1ULL << 63);
+}
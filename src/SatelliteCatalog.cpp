@@ -0,0 +1,59 @@
+/****************************************************************/
+/*                       SatelliteCatalog                       */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        Dense table of active objects built once at load.     */
+/****************************************************************/
+
+#include <cmath>
+
+#include "SatelliteCatalog.h"
+
+bool preferEpoch(double candidate, double current, double analysisTime) {
+    if (analysisTime == SELECT_NEWEST_EPOCH) {
+        return candidate > current;
+    }
+
+    double candidateGap = fabs(candidate - analysisTime);
+    double currentGap = fabs(current - analysisTime);
+    return candidateGap < currentGap || (candidateGap == currentGap && candidate > current);
+}
+
+vector<int> selectElementSets(const vector<int>& ids, const vector<double>& epochs, double analysisTime) {
+    vector<int> survivors;
+    unordered_map<int, int> slotById;   // NORAD id -> index into survivors
+    slotById.reserve(ids.size());
+
+    for (int i = 0; i < (int)ids.size(); i++) {
+        auto found = slotById.emplace(ids[i], survivors.size());
+
+        if (found.second) {
+            survivors.push_back(i);
+        } else if (preferEpoch(epochs[i], epochs[survivors[found.first->second]], analysisTime)) {
+            survivors[found.first->second] = i;
+        }
+    }
+
+    return survivors;
+}
+
+void SatelliteCatalog::clear() {
+    entries.clear();
+    loadedIds.clear();
+}
+
+bool SatelliteCatalog::add(__int64 satKey, int source, int noradId) {
+    if (!loadedIds.insert(noradId).second) {
+        return false;
+    }
+
+    CatalogEntry entry;
+    entry.satKey = satKey;
+    entry.source = source;
+    entry.noradId = noradId;
+    entry.slot = entries.size();
+    entries.push_back(entry);
+
+    return true;
+}
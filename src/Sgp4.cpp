@@ -0,0 +1,1089 @@
+/****************************************************************/
+/*                             Sgp4                             */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        Native SGP4/SDP4 propagator. The algorithm follows    */
+/*        Vallado, Crawford, Hujsak and Kelso, "Revisiting      */
+/*        Spacetrack Report #3" (AIAA 2006-6753) in its         */
+/*        improved ('i') operation mode, so results agree with  */
+/*        the Astro Standards Sgp4Prop library to round-off.    */
+/*                                                              */
+/*        Unlike the reference code, propagation takes the      */
+/*        satellite record as const: the deep-space resonance   */
+/*        integrator restarts from epoch on every call instead  */
+/*        of caching its last step inside the record.           */
+/****************************************************************/
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "Sgp4.h"
+
+namespace {
+
+const double PI_D   = 3.14159265358979323846;
+const double TWOPI  = 2.0 * PI_D;
+const double X2O3   = 2.0 / 3.0;
+const double DEG2RAD = PI_D / 180.0;
+
+// Lunar-solar terms shared between dscom, dpper and dsinit
+struct DeepCommon {
+    double snodm, cnodm, sinim, cosim, sinomm, cosomm, day, emsq, gam, rtemsq;
+    double s1, s2, s3, s4, s5, s6, s7;
+    double ss1, ss2, ss3, ss4, ss5, ss6, ss7;
+    double sz1, sz2, sz3, sz11, sz12, sz13, sz21, sz22, sz23, sz31, sz32, sz33;
+    double z1, z2, z3, z11, z12, z13, z21, z22, z23, z31, z32, z33;
+    double nm, em;
+};
+
+double julianDay(int year, int mon, int day, int hr, int minute, double sec) {
+    return 367.0 * year - floor((7 * (year + floor((mon + 9) / 12.0))) * 0.25) +
+           floor(275 * mon / 9.0) + day + 1721013.5 +
+           ((sec / 60.0 + minute) / 60.0 + hr) / 24.0;
+}
+
+// Greenwich sidereal time (rad) for a UT1 Julian date
+double greenwichSidereal(double jdut1) {
+    double tut1 = (jdut1 - 2451545.0) / 36525.0;
+    double temp = -6.2e-6 * tut1 * tut1 * tut1 + 0.093104 * tut1 * tut1 +
+                  (876600.0 * 3600 + 8640184.812866) * tut1 + 67310.54841;
+    temp = fmod(temp * DEG2RAD / 240.0, TWOPI);
+    if (temp < 0.0) {
+        temp += TWOPI;
+    }
+    return temp;
+}
+
+// Copy a fixed-width column range into a terminated buffer, optionally
+// inserting an implied leading decimal point and exponent (e.g. " 12345-3").
+bool columnToDouble(const char* line, int start, int len, double& value) {
+    char buf[32];
+    int n = 0;
+    for (int i = start; i < start + len && line[i] != '\0' && line[i] != '\n' && line[i] != '\r'; i++) {
+        if (line[i] != ' ') {
+            buf[n++] = line[i];
+        }
+    }
+    if (n == 0) {
+        value = 0.0;
+        return true;
+    }
+    buf[n] = '\0';
+    char* end;
+    value = strtod(buf, &end);
+    return *end == '\0';
+}
+
+// Fields such as B* are written as [sign]mantissa[sign]exponent with an implied decimal point
+bool impliedExponentToDouble(const char* line, int start, int len, double& value) {
+    char buf[32];
+    int n = 0;
+    int i = start;
+    int stop = start + len;
+
+    if (line[i] == '-' || line[i] == '+') {
+        buf[n++] = line[i++];
+    } else if (line[i] == ' ') {
+        i++;
+    }
+    buf[n++] = '.';
+    for (; i < stop && line[i] != '-' && line[i] != '+'; i++) {
+        if (line[i] != ' ') {
+            buf[n++] = line[i];
+        }
+    }
+    if (i < stop) {
+        buf[n++] = 'e';
+        for (; i < stop; i++) {
+            if (line[i] != ' ') {
+                buf[n++] = line[i];
+            }
+        }
+    }
+    buf[n] = '\0';
+    if (n == 1) {
+        value = 0.0;
+        return true;
+    }
+    char* end;
+    value = strtod(buf, &end);
+    return *end == '\0';
+}
+
+// Catalog numbers above 99999 use the Alpha-5 scheme (A = 10, skipping I and O)
+bool parseSatNum(const char* field, int& satNum) {
+    int digits = 0;
+    int value = 0;
+    int i = 0;
+    while (i < 5 && field[i] == ' ') {
+        i++;
+    }
+    if (i < 5 && field[i] >= 'A' && field[i] <= 'Z') {
+        char c = field[i];
+        if (c == 'I' || c == 'O') {
+            return false;
+        }
+        value = c - 'A' + 10;
+        if (c > 'I') value--;
+        if (c > 'O') value--;
+        i++;
+        digits++;
+    }
+    for (; i < 5; i++) {
+        if (field[i] < '0' || field[i] > '9') {
+            return false;
+        }
+        value = value * 10 + (field[i] - '0');
+        digits++;
+    }
+    satNum = value;
+    return digits > 0;
+}
+
+// Brouwer mean motion from the Kozai mean motion in the element set
+double unKozai(double noKozai, double cosio2, double omeosq, double rteosq) {
+    double ak = pow(SGP4_XKE / noKozai, X2O3);
+    double d1 = 0.75 * SGP4_J2 * (3.0 * cosio2 - 1.0) / (rteosq * omeosq);
+    double del = d1 / (ak * ak);
+    double adel = ak * (1.0 - del * del - del * (1.0 / 3.0 + 134.0 * del * del / 81.0));
+    del = d1 / (adel * adel);
+    return noKozai / (1.0 + del);
+}
+
+void initl(double epoch, double ecco, double inclo, double noKozai,
+           double& ainv, double& ao, double& con41, double& con42, double& cosio,
+           double& cosio2, double& eccsq, double& omeosq, double& posq, double& rp,
+           double& rteosq, double& sinio, double& gsto, double& noUnkozai) {
+    eccsq = ecco * ecco;
+    omeosq = 1.0 - eccsq;
+    rteosq = sqrt(omeosq);
+    cosio = cos(inclo);
+    cosio2 = cosio * cosio;
+
+    noUnkozai = unKozai(noKozai, cosio2, omeosq, rteosq);
+
+    ao = pow(SGP4_XKE / noUnkozai, X2O3);
+    sinio = sin(inclo);
+    double po = ao * omeosq;
+    con42 = 1.0 - 5.0 * cosio2;
+    con41 = -con42 - cosio2 - cosio2;
+    ainv = 1.0 / ao;
+    posq = po * po;
+    rp = ao * (1.0 - ecco);
+
+    gsto = greenwichSidereal(epoch + SGP4_JD_DS50);
+}
+
+void dscom(double epoch, double ep, double argpp, double tc, double inclp,
+           double nodep, double np, Sgp4Sat& sat, DeepCommon& dc) {
+    const double zes    = 0.01675;
+    const double zel    = 0.05490;
+    const double c1ss   = 2.9864797e-6;
+    const double c1l    = 4.7968065e-7;
+    const double zsinis = 0.39785416;
+    const double zcosis = 0.91744867;
+    const double zcosgs = 0.1945905;
+    const double zsings = -0.98088458;
+
+    dc.nm = np;
+    dc.em = ep;
+    dc.snodm = sin(nodep);
+    dc.cnodm = cos(nodep);
+    dc.sinomm = sin(argpp);
+    dc.cosomm = cos(argpp);
+    dc.sinim = sin(inclp);
+    dc.cosim = cos(inclp);
+    dc.emsq = dc.em * dc.em;
+    double betasq = 1.0 - dc.emsq;
+    dc.rtemsq = sqrt(betasq);
+
+    sat.peo = 0.0;
+    sat.pinco = 0.0;
+    sat.plo = 0.0;
+    sat.pgho = 0.0;
+    sat.pho = 0.0;
+    dc.day = epoch + 18261.5 + tc / 1440.0;
+    double xnodce = fmod(4.5236020 - 9.2422029e-4 * dc.day, TWOPI);
+    double stem = sin(xnodce);
+    double ctem = cos(xnodce);
+    double zcosil = 0.91375164 - 0.03568096 * ctem;
+    double zsinil = sqrt(1.0 - zcosil * zcosil);
+    double zsinhl = 0.089683511 * stem / zsinil;
+    double zcoshl = sqrt(1.0 - zsinhl * zsinhl);
+    dc.gam = 5.8351514 + 0.0019443680 * dc.day;
+    double zx = 0.39785416 * stem / zsinil;
+    double zy = zcoshl * ctem + 0.91744867 * zsinhl * stem;
+    zx = atan2(zx, zy);
+    zx = dc.gam + zx - xnodce;
+    double zcosgl = cos(zx);
+    double zsingl = sin(zx);
+
+    // Solar terms first, then lunar
+    double zcosg = zcosgs;
+    double zsing = zsings;
+    double zcosi = zcosis;
+    double zsini = zsinis;
+    double zcosh = dc.cnodm;
+    double zsinh = dc.snodm;
+    double cc = c1ss;
+    double xnoi = 1.0 / dc.nm;
+
+    for (int lsflg = 1; lsflg <= 2; lsflg++) {
+        double a1 = zcosg * zcosh + zsing * zcosi * zsinh;
+        double a3 = -zsing * zcosh + zcosg * zcosi * zsinh;
+        double a7 = -zcosg * zsinh + zsing * zcosi * zcosh;
+        double a8 = zsing * zsini;
+        double a9 = zsing * zsinh + zcosg * zcosi * zcosh;
+        double a10 = zcosg * zsini;
+        double a2 = dc.cosim * a7 + dc.sinim * a8;
+        double a4 = dc.cosim * a9 + dc.sinim * a10;
+        double a5 = -dc.sinim * a7 + dc.cosim * a8;
+        double a6 = -dc.sinim * a9 + dc.cosim * a10;
+
+        double x1 = a1 * dc.cosomm + a2 * dc.sinomm;
+        double x2 = a3 * dc.cosomm + a4 * dc.sinomm;
+        double x3 = -a1 * dc.sinomm + a2 * dc.cosomm;
+        double x4 = -a3 * dc.sinomm + a4 * dc.cosomm;
+        double x5 = a5 * dc.sinomm;
+        double x6 = a6 * dc.sinomm;
+        double x7 = a5 * dc.cosomm;
+        double x8 = a6 * dc.cosomm;
+
+        dc.z31 = 12.0 * x1 * x1 - 3.0 * x3 * x3;
+        dc.z32 = 24.0 * x1 * x2 - 6.0 * x3 * x4;
+        dc.z33 = 12.0 * x2 * x2 - 3.0 * x4 * x4;
+        dc.z1 = 3.0 * (a1 * a1 + a2 * a2) + dc.z31 * dc.emsq;
+        dc.z2 = 6.0 * (a1 * a3 + a2 * a4) + dc.z32 * dc.emsq;
+        dc.z3 = 3.0 * (a3 * a3 + a4 * a4) + dc.z33 * dc.emsq;
+        dc.z11 = -6.0 * a1 * a5 + dc.emsq * (-24.0 * x1 * x7 - 6.0 * x3 * x5);
+        dc.z12 = -6.0 * (a1 * a6 + a3 * a5) + dc.emsq *
+                 (-24.0 * (x2 * x7 + x1 * x8) - 6.0 * (x3 * x6 + x4 * x5));
+        dc.z13 = -6.0 * a3 * a6 + dc.emsq * (-24.0 * x2 * x8 - 6.0 * x4 * x6);
+        dc.z21 = 6.0 * a2 * a5 + dc.emsq * (24.0 * x1 * x5 - 6.0 * x3 * x7);
+        dc.z22 = 6.0 * (a4 * a5 + a2 * a6) + dc.emsq *
+                 (24.0 * (x2 * x5 + x1 * x6) - 6.0 * (x4 * x7 + x3 * x8));
+        dc.z23 = 6.0 * a4 * a6 + dc.emsq * (24.0 * x2 * x6 - 6.0 * x4 * x8);
+        dc.z1 = dc.z1 + dc.z1 + betasq * dc.z31;
+        dc.z2 = dc.z2 + dc.z2 + betasq * dc.z32;
+        dc.z3 = dc.z3 + dc.z3 + betasq * dc.z33;
+        dc.s3 = cc * xnoi;
+        dc.s2 = -0.5 * dc.s3 / dc.rtemsq;
+        dc.s4 = dc.s3 * dc.rtemsq;
+        dc.s1 = -15.0 * dc.em * dc.s4;
+        dc.s5 = x1 * x3 + x2 * x4;
+        dc.s6 = x2 * x3 + x1 * x4;
+        dc.s7 = x2 * x4 - x1 * x3;
+
+        if (lsflg == 1) {
+            dc.ss1 = dc.s1;
+            dc.ss2 = dc.s2;
+            dc.ss3 = dc.s3;
+            dc.ss4 = dc.s4;
+            dc.ss5 = dc.s5;
+            dc.ss6 = dc.s6;
+            dc.ss7 = dc.s7;
+            dc.sz1 = dc.z1;
+            dc.sz2 = dc.z2;
+            dc.sz3 = dc.z3;
+            dc.sz11 = dc.z11;
+            dc.sz12 = dc.z12;
+            dc.sz13 = dc.z13;
+            dc.sz21 = dc.z21;
+            dc.sz22 = dc.z22;
+            dc.sz23 = dc.z23;
+            dc.sz31 = dc.z31;
+            dc.sz32 = dc.z32;
+            dc.sz33 = dc.z33;
+            zcosg = zcosgl;
+            zsing = zsingl;
+            zcosi = zcosil;
+            zsini = zsinil;
+            zcosh = zcoshl * dc.cnodm + zsinhl * dc.snodm;
+            zsinh = dc.snodm * zcoshl - dc.cnodm * zsinhl;
+            cc = c1l;
+        }
+    }
+
+    sat.zmol = fmod(4.7199672 + 0.22997150 * dc.day - dc.gam, TWOPI);
+    sat.zmos = fmod(6.2565837 + 0.017201977 * dc.day, TWOPI);
+
+    // Solar terms
+    sat.se2 = 2.0 * dc.ss1 * dc.ss6;
+    sat.se3 = 2.0 * dc.ss1 * dc.ss7;
+    sat.si2 = 2.0 * dc.ss2 * dc.sz12;
+    sat.si3 = 2.0 * dc.ss2 * (dc.sz13 - dc.sz11);
+    sat.sl2 = -2.0 * dc.ss3 * dc.sz2;
+    sat.sl3 = -2.0 * dc.ss3 * (dc.sz3 - dc.sz1);
+    sat.sl4 = -2.0 * dc.ss3 * (-21.0 - 9.0 * dc.emsq) * zes;
+    sat.sgh2 = 2.0 * dc.ss4 * dc.sz32;
+    sat.sgh3 = 2.0 * dc.ss4 * (dc.sz33 - dc.sz31);
+    sat.sgh4 = -18.0 * dc.ss4 * zes;
+    sat.sh2 = -2.0 * dc.ss2 * dc.sz22;
+    sat.sh3 = -2.0 * dc.ss2 * (dc.sz23 - dc.sz21);
+
+    // Lunar terms
+    sat.ee2 = 2.0 * dc.s1 * dc.s6;
+    sat.e3 = 2.0 * dc.s1 * dc.s7;
+    sat.xi2 = 2.0 * dc.s2 * dc.z12;
+    sat.xi3 = 2.0 * dc.s2 * (dc.z13 - dc.z11);
+    sat.xl2 = -2.0 * dc.s3 * dc.z2;
+    sat.xl3 = -2.0 * dc.s3 * (dc.z3 - dc.z1);
+    sat.xl4 = -2.0 * dc.s3 * (-21.0 - 9.0 * dc.emsq) * zel;
+    sat.xgh2 = 2.0 * dc.s4 * dc.z32;
+    sat.xgh3 = 2.0 * dc.s4 * (dc.z33 - dc.z31);
+    sat.xgh4 = -18.0 * dc.s4 * zel;
+    sat.xh2 = -2.0 * dc.s2 * dc.z22;
+    sat.xh3 = -2.0 * dc.s2 * (dc.z23 - dc.z21);
+}
+
+// Lunar-solar periodic perturbations, applied during propagation only
+void dpper(const Sgp4Sat& sat, double t, double& ep, double& inclp,
+           double& nodep, double& argpp, double& mp) {
+    const double zns = 1.19459e-5;
+    const double zes = 0.01675;
+    const double znl = 1.5835218e-4;
+    const double zel = 0.05490;
+
+    double zm = sat.zmos + zns * t;
+    double zf = zm + 2.0 * zes * sin(zm);
+    double sinzf = sin(zf);
+    double f2 = 0.5 * sinzf * sinzf - 0.25;
+    double f3 = -0.5 * sinzf * cos(zf);
+    double ses = sat.se2 * f2 + sat.se3 * f3;
+    double sis = sat.si2 * f2 + sat.si3 * f3;
+    double sls = sat.sl2 * f2 + sat.sl3 * f3 + sat.sl4 * sinzf;
+    double sghs = sat.sgh2 * f2 + sat.sgh3 * f3 + sat.sgh4 * sinzf;
+    double shs = sat.sh2 * f2 + sat.sh3 * f3;
+
+    zm = sat.zmol + znl * t;
+    zf = zm + 2.0 * zel * sin(zm);
+    sinzf = sin(zf);
+    f2 = 0.5 * sinzf * sinzf - 0.25;
+    f3 = -0.5 * sinzf * cos(zf);
+    double sel = sat.ee2 * f2 + sat.e3 * f3;
+    double sil = sat.xi2 * f2 + sat.xi3 * f3;
+    double sll = sat.xl2 * f2 + sat.xl3 * f3 + sat.xl4 * sinzf;
+    double sghl = sat.xgh2 * f2 + sat.xgh3 * f3 + sat.xgh4 * sinzf;
+    double shll = sat.xh2 * f2 + sat.xh3 * f3;
+
+    double pe = ses + sel - sat.peo;
+    double pinc = sis + sil - sat.pinco;
+    double pl = sls + sll - sat.plo;
+    double pgh = sghs + sghl - sat.pgho;
+    double ph = shs + shll - sat.pho;
+
+    inclp = inclp + pinc;
+    ep = ep + pe;
+    double sinip = sin(inclp);
+    double cosip = cos(inclp);
+
+    if (inclp >= 0.2) {
+        ph = ph / sinip;
+        pgh = pgh - cosip * ph;
+        argpp = argpp + pgh;
+        nodep = nodep + ph;
+        mp = mp + pl;
+    } else {
+        // Lyddane modification for low inclinations
+        double sinop = sin(nodep);
+        double cosop = cos(nodep);
+        double alfdp = sinip * sinop;
+        double betdp = sinip * cosop;
+        double dalf = ph * cosop + pinc * cosip * sinop;
+        double dbet = -ph * sinop + pinc * cosip * cosop;
+        alfdp = alfdp + dalf;
+        betdp = betdp + dbet;
+        nodep = fmod(nodep, TWOPI);
+        double xls = mp + argpp + cosip * nodep;
+        double dls = pl + pgh - pinc * nodep * sinip;
+        xls = xls + dls;
+        double xnoh = nodep;
+        nodep = atan2(alfdp, betdp);
+        if (fabs(xnoh - nodep) > PI_D) {
+            if (nodep < xnoh) {
+                nodep = nodep + TWOPI;
+            } else {
+                nodep = nodep - TWOPI;
+            }
+        }
+        mp = mp + pl;
+        argpp = xls - mp - cosip * nodep;
+    }
+}
+
+void dsinit(Sgp4Sat& sat, const DeepCommon& dc, double xpidot, double eccsq) {
+    const double q22    = 1.7891679e-6;
+    const double q31    = 2.1460748e-6;
+    const double q33    = 2.2123015e-7;
+    const double root22 = 1.7891679e-6;
+    const double root44 = 7.3636953e-9;
+    const double root54 = 2.1765803e-9;
+    const double rptim  = 4.37526908801129966e-3;
+    const double root32 = 3.7393792e-7;
+    const double root52 = 1.1428639e-7;
+    const double znl    = 1.5835218e-4;
+    const double zns    = 1.19459e-5;
+
+    double nm = dc.nm;
+    double em = dc.em;
+    double emsq = dc.emsq;
+    double inclm = sat.inclo;
+
+    sat.irez = 0;
+    if ((nm < 0.0052359877) && (nm > 0.0034906585)) {
+        sat.irez = 1;
+    }
+    if ((nm >= 8.26e-3) && (nm <= 9.24e-3) && (em >= 0.5)) {
+        sat.irez = 2;
+    }
+
+    // Solar secular rates
+    double ses = dc.ss1 * zns * dc.ss5;
+    double sis = dc.ss2 * zns * (dc.sz11 + dc.sz13);
+    double sls = -zns * dc.ss3 * (dc.sz1 + dc.sz3 - 14.0 - 6.0 * emsq);
+    double sghs = dc.ss4 * zns * (dc.sz31 + dc.sz33 - 6.0);
+    double shs = -zns * dc.ss2 * (dc.sz21 + dc.sz23);
+    if ((inclm < 5.2359877e-2) || (inclm > PI_D - 5.2359877e-2)) {
+        shs = 0.0;
+    }
+    if (dc.sinim != 0.0) {
+        shs = shs / dc.sinim;
+    }
+    double sgs = sghs - dc.cosim * shs;
+
+    // Lunar secular rates
+    sat.dedt = ses + dc.s1 * znl * dc.s5;
+    sat.didt = sis + dc.s2 * znl * (dc.z11 + dc.z13);
+    sat.dmdt = sls - znl * dc.s3 * (dc.z1 + dc.z3 - 14.0 - 6.0 * emsq);
+    double sghl = dc.s4 * znl * (dc.z31 + dc.z33 - 6.0);
+    double shll = -znl * dc.s2 * (dc.z21 + dc.z23);
+    if ((inclm < 5.2359877e-2) || (inclm > PI_D - 5.2359877e-2)) {
+        shll = 0.0;
+    }
+    sat.domdt = sgs + sghl;
+    sat.dnodt = shs;
+    if (dc.sinim != 0.0) {
+        sat.domdt = sat.domdt - dc.cosim / dc.sinim * shll;
+        sat.dnodt = sat.dnodt + shll / dc.sinim;
+    }
+
+    // Deep-space resonance effects
+    double theta = fmod(sat.gsto, TWOPI);
+
+    if (sat.irez != 0) {
+        double aonv = pow(nm / SGP4_XKE, X2O3);
+
+        // Geopotential resonance for 12 hour orbits
+        if (sat.irez == 2) {
+            double cosisq = dc.cosim * dc.cosim;
+            em = sat.ecco;
+            emsq = eccsq;
+            double eoc = em * emsq;
+            double g201 = -0.306 - (em - 0.64) * 0.440;
+            double g211, g310, g322, g410, g422, g520, g521, g532, g533;
+
+            if (em <= 0.65) {
+                g211 = 3.616 - 13.2470 * em + 16.2900 * emsq;
+                g310 = -19.302 + 117.3900 * em - 228.4190 * emsq + 156.5910 * eoc;
+                g322 = -18.9068 + 109.7927 * em - 214.6334 * emsq + 146.5816 * eoc;
+                g410 = -41.122 + 242.6940 * em - 471.0940 * emsq + 313.9530 * eoc;
+                g422 = -146.407 + 841.8800 * em - 1629.014 * emsq + 1083.4350 * eoc;
+                g520 = -532.114 + 3017.977 * em - 5740.032 * emsq + 3708.2760 * eoc;
+            } else {
+                g211 = -72.099 + 331.819 * em - 508.738 * emsq + 266.724 * eoc;
+                g310 = -346.844 + 1582.851 * em - 2415.925 * emsq + 1246.113 * eoc;
+                g322 = -342.585 + 1554.908 * em - 2366.899 * emsq + 1215.972 * eoc;
+                g410 = -1052.797 + 4758.686 * em - 7193.992 * emsq + 3651.957 * eoc;
+                g422 = -3581.690 + 16178.110 * em - 24462.770 * emsq + 12422.520 * eoc;
+                if (em > 0.715) {
+                    g520 = -5149.66 + 29936.92 * em - 54087.36 * emsq + 31324.56 * eoc;
+                } else {
+                    g520 = 1464.74 - 4664.75 * em + 3763.64 * emsq;
+                }
+            }
+            if (em < 0.7) {
+                g533 = -919.22770 + 4988.6100 * em - 9064.7700 * emsq + 5542.21 * eoc;
+                g521 = -822.71072 + 4568.6173 * em - 8491.4146 * emsq + 5337.524 * eoc;
+                g532 = -853.66600 + 4690.2500 * em - 8624.7700 * emsq + 5341.4 * eoc;
+            } else {
+                g533 = -37995.780 + 161616.52 * em - 229838.20 * emsq + 109377.94 * eoc;
+                g521 = -51752.104 + 218913.95 * em - 309468.16 * emsq + 146349.42 * eoc;
+                g532 = -40023.880 + 170470.89 * em - 242699.48 * emsq + 115605.82 * eoc;
+            }
+
+            double sini2 = dc.sinim * dc.sinim;
+            double f220 = 0.75 * (1.0 + 2.0 * dc.cosim + cosisq);
+            double f221 = 1.5 * sini2;
+            double f321 = 1.875 * dc.sinim * (1.0 - 2.0 * dc.cosim - 3.0 * cosisq);
+            double f322 = -1.875 * dc.sinim * (1.0 + 2.0 * dc.cosim - 3.0 * cosisq);
+            double f441 = 35.0 * sini2 * f220;
+            double f442 = 39.3750 * sini2 * sini2;
+            double f522 = 9.84375 * dc.sinim * (sini2 * (1.0 - 2.0 * dc.cosim - 5.0 * cosisq) +
+                          0.33333333 * (-2.0 + 4.0 * dc.cosim + 6.0 * cosisq));
+            double f523 = dc.sinim * (4.92187512 * sini2 * (-2.0 - 4.0 * dc.cosim + 10.0 * cosisq) +
+                          6.56250012 * (1.0 + 2.0 * dc.cosim - 3.0 * cosisq));
+            double f542 = 29.53125 * dc.sinim * (2.0 - 8.0 * dc.cosim + cosisq *
+                          (-12.0 + 8.0 * dc.cosim + 10.0 * cosisq));
+            double f543 = 29.53125 * dc.sinim * (-2.0 - 8.0 * dc.cosim + cosisq *
+                          (12.0 + 8.0 * dc.cosim - 10.0 * cosisq));
+
+            double xno2 = nm * nm;
+            double ainv2 = aonv * aonv;
+            double temp1 = 3.0 * xno2 * ainv2;
+            double temp = temp1 * root22;
+            sat.d2201 = temp * f220 * g201;
+            sat.d2211 = temp * f221 * g211;
+            temp1 = temp1 * aonv;
+            temp = temp1 * root32;
+            sat.d3210 = temp * f321 * g310;
+            sat.d3222 = temp * f322 * g322;
+            temp1 = temp1 * aonv;
+            temp = 2.0 * temp1 * root44;
+            sat.d4410 = temp * f441 * g410;
+            sat.d4422 = temp * f442 * g422;
+            temp1 = temp1 * aonv;
+            temp = temp1 * root52;
+            sat.d5220 = temp * f522 * g520;
+            sat.d5232 = temp * f523 * g532;
+            temp = 2.0 * temp1 * root54;
+            sat.d5421 = temp * f542 * g521;
+            sat.d5433 = temp * f543 * g533;
+            sat.xlamo = fmod(sat.mo + sat.nodeo + sat.nodeo - theta - theta, TWOPI);
+            sat.xfact = sat.mdot + sat.dmdt + 2.0 * (sat.nodedot + sat.dnodt - rptim) - sat.noUnkozai;
+        }
+
+        // Synchronous resonance terms
+        if (sat.irez == 1) {
+            double g200 = 1.0 + emsq * (-2.5 + 0.8125 * emsq);
+            double g310 = 1.0 + 2.0 * emsq;
+            double g300 = 1.0 + emsq * (-6.0 + 6.60937 * emsq);
+            double f220 = 0.75 * (1.0 + dc.cosim) * (1.0 + dc.cosim);
+            double f311 = 0.9375 * dc.sinim * dc.sinim * (1.0 + 3.0 * dc.cosim) - 0.75 * (1.0 + dc.cosim);
+            double f330 = 1.0 + dc.cosim;
+            f330 = 1.875 * f330 * f330 * f330;
+            sat.del1 = 3.0 * nm * nm * aonv * aonv;
+            sat.del2 = 2.0 * sat.del1 * f220 * g200 * q22;
+            sat.del3 = 3.0 * sat.del1 * f330 * g300 * q33 * aonv;
+            sat.del1 = sat.del1 * f311 * g310 * q31 * aonv;
+            sat.xlamo = fmod(sat.mo + sat.nodeo + sat.argpo - theta, TWOPI);
+            sat.xfact = sat.mdot + xpidot - rptim + sat.dmdt + sat.domdt + sat.dnodt - sat.noUnkozai;
+        }
+    }
+}
+
+// Deep-space secular effects and resonance integration. The integrator
+// always starts at epoch so the satellite record can stay const.
+void dspace(const Sgp4Sat& sat, double t, double& em, double& argpm, double& inclm,
+            double& mm, double& nodem, double& nm) {
+    const double fasx2 = 0.13130908;
+    const double fasx4 = 2.8843198;
+    const double fasx6 = 0.37448087;
+    const double g22   = 5.7686396;
+    const double g32   = 0.95240898;
+    const double g44   = 1.8014998;
+    const double g52   = 1.0508330;
+    const double g54   = 4.4108898;
+    const double rptim = 4.37526908801129966e-3;
+    const double stepp = 720.0;
+    const double stepn = -720.0;
+    const double step2 = 259200.0;
+
+    double theta = fmod(sat.gsto + t * rptim, TWOPI);
+    em = em + sat.dedt * t;
+    inclm = inclm + sat.didt * t;
+    argpm = argpm + sat.domdt * t;
+    nodem = nodem + sat.dnodt * t;
+    mm = mm + sat.dmdt * t;
+
+    if (sat.irez == 0) {
+        return;
+    }
+
+    double atime = 0.0;
+    double xni = sat.noUnkozai;
+    double xli = sat.xlamo;
+    double delt = (t > 0.0) ? stepp : stepn;
+    double ft = 0.0;
+    double xndt = 0.0, xldot = 0.0, xnddt = 0.0;
+
+    for (;;) {
+        if (sat.irez != 2) {
+            // Near-synchronous resonance terms
+            xndt = sat.del1 * sin(xli - fasx2) + sat.del2 * sin(2.0 * (xli - fasx4)) +
+                   sat.del3 * sin(3.0 * (xli - fasx6));
+            xldot = xni + sat.xfact;
+            xnddt = sat.del1 * cos(xli - fasx2) + 2.0 * sat.del2 * cos(2.0 * (xli - fasx4)) +
+                    3.0 * sat.del3 * cos(3.0 * (xli - fasx6));
+            xnddt = xnddt * xldot;
+        } else {
+            // Near-half-day resonance terms
+            double xomi = sat.argpo + sat.argpdot * atime;
+            double x2omi = xomi + xomi;
+            double x2li = xli + xli;
+            xndt = sat.d2201 * sin(x2omi + xli - g22) + sat.d2211 * sin(xli - g22) +
+                   sat.d3210 * sin(xomi + xli - g32) + sat.d3222 * sin(-xomi + xli - g32) +
+                   sat.d4410 * sin(x2omi + x2li - g44) + sat.d4422 * sin(x2li - g44) +
+                   sat.d5220 * sin(xomi + xli - g52) + sat.d5232 * sin(-xomi + xli - g52) +
+                   sat.d5421 * sin(xomi + x2li - g54) + sat.d5433 * sin(-xomi + x2li - g54);
+            xldot = xni + sat.xfact;
+            xnddt = sat.d2201 * cos(x2omi + xli - g22) + sat.d2211 * cos(xli - g22) +
+                    sat.d3210 * cos(xomi + xli - g32) + sat.d3222 * cos(-xomi + xli - g32) +
+                    sat.d5220 * cos(xomi + xli - g52) + sat.d5232 * cos(-xomi + xli - g52) +
+                    2.0 * (sat.d4410 * cos(x2omi + x2li - g44) + sat.d4422 * cos(x2li - g44) +
+                    sat.d5421 * cos(xomi + x2li - g54) + sat.d5433 * cos(-xomi + x2li - g54));
+            xnddt = xnddt * xldot;
+        }
+
+        if (fabs(t - atime) < stepp) {
+            ft = t - atime;
+            break;
+        }
+
+        xli = xli + xldot * delt + xndt * step2;
+        xni = xni + xndt * delt + xnddt * step2;
+        atime = atime + delt;
+    }
+
+    nm = xni + xndt * ft + xnddt * ft * ft * 0.5;
+    double xl = xli + xldot * ft + xndt * ft * ft * 0.5;
+    if (sat.irez != 1) {
+        mm = xl - 2.0 * nodem + 2.0 * theta;
+    } else {
+        mm = xl - nodem - argpm + theta;
+    }
+}
+
+} // namespace
+
+bool parseTleLines(const char* line1, const char* line2, TleElements& el) {
+    return parseTleLines(line1, strlen(line1), line2, strlen(line2), el);
+}
+
+bool tleChecksumValid(const char* line, int len) {
+    if (len < 69) {
+        return true;
+    }
+
+    int sum = 0;
+    for (int i = 0; i < 68; i++) {
+        if (line[i] >= '0' && line[i] <= '9') {
+            sum += line[i] - '0';
+        } else if (line[i] == '-') {
+            sum++;
+        }
+    }
+
+    return line[68] - '0' == sum % 10;
+}
+
+bool parseTleLines(const char* line1, int len1, const char* line2, int len2, TleElements& el) {
+    if (len1 < 64 || len2 < 63 || line1[0] != '1' || line2[0] != '2') {
+        return false;
+    }
+
+    if (!parseSatNum(line1 + 2, el.satNum)) {
+        return false;
+    }
+
+    double epochYear, epochDay;
+    double ndot, nddot, bstar;
+    double incl, raan, ecc, argp, mo, no;
+
+    bool ok = columnToDouble(line1, 18, 2, epochYear) &&
+              columnToDouble(line1, 20, 12, epochDay) &&
+              columnToDouble(line1, 33, 10, ndot) &&
+              impliedExponentToDouble(line1, 44, 8, nddot) &&
+              impliedExponentToDouble(line1, 53, 8, bstar) &&
+              columnToDouble(line2, 8, 8, incl) &&
+              columnToDouble(line2, 17, 8, raan) &&
+              columnToDouble(line2, 26, 7, ecc) &&
+              columnToDouble(line2, 34, 8, argp) &&
+              columnToDouble(line2, 43, 8, mo) &&
+              columnToDouble(line2, 52, 11, no);
+    if (!ok) {
+        return false;
+    }
+
+    int year = static_cast<int>(epochYear);
+    year += (year < 57) ? 2000 : 1900;
+
+    // Days since 1950 Jan 0.0 of the epoch year's Jan 0.0, plus the day of year
+    el.epochDs50UTC = julianDay(year, 1, 1, 0, 0, 0.0) - 1.0 - SGP4_JD_DS50 + epochDay;
+
+    elementsFromTleUnits(no, ndot, nddot, bstar, incl, raan, ecc * 1.0e-7, argp, mo, el);
+
+    return true;
+}
+
+void elementsFromTleUnits(double no, double ndot, double nddot, double bstar, double incl,
+                          double raan, double ecc, double argp, double mo, TleElements& el) {
+    const double xpdotp = 1440.0 / TWOPI;  // rev/day per rad/min
+    el.no    = no / xpdotp;
+    el.ndot  = ndot / (xpdotp * 1440.0);
+    el.nddot = nddot / (xpdotp * 1440.0 * 1440.0);
+    el.bstar = bstar;
+    el.incl  = incl * DEG2RAD;
+    el.raan  = raan * DEG2RAD;
+    el.ecc   = ecc;
+    el.argp  = argp * DEG2RAD;
+    el.mo    = mo * DEG2RAD;
+}
+
+double calendarToDs50(int year, int mon, int day, int hr, int minute, double sec) {
+    return julianDay(year, mon, day, hr, minute, sec) - SGP4_JD_DS50;
+}
+
+bool parseCatalogNumber(const char* field, int& satNum) {
+    return parseSatNum(field, satNum);
+}
+
+void meanAltitudes(const TleElements& el, double& perigeeKm, double& apogeeKm) {
+    double cosio = cos(el.incl);
+    double omeosq = 1.0 - el.ecc * el.ecc;
+    double noUnkozai = unKozai(el.no, cosio * cosio, omeosq, sqrt(omeosq));
+
+    // Same as sgp4Init's altp and alta, in km
+    double a = pow(noUnkozai * SGP4_TUMIN, -X2O3);
+    perigeeKm = (a * (1.0 - el.ecc) - 1.0) * SGP4_RADIUS_KM;
+    apogeeKm = (a * (1.0 + el.ecc) - 1.0) * SGP4_RADIUS_KM;
+}
+
+int sgp4Init(const TleElements& el, Sgp4Sat& sat) {
+    const double temp4 = 1.5e-12;
+
+    memset(&sat, 0, sizeof(Sgp4Sat));
+
+    sat.satNum = el.satNum;
+    sat.epochDs50UTC = el.epochDs50UTC;
+    sat.bstar = el.bstar;
+    sat.ecco = el.ecc;
+    sat.argpo = el.argp;
+    sat.inclo = el.incl;
+    sat.mo = el.mo;
+    sat.nodeo = el.raan;
+    sat.method = 'n';
+
+    double ss = 78.0 / SGP4_RADIUS_KM + 1.0;
+    double qzms2ttemp = (120.0 - 78.0) / SGP4_RADIUS_KM;
+    double qzms2t = qzms2ttemp * qzms2ttemp * qzms2ttemp * qzms2ttemp;
+
+    double ainv, ao, con42, cosio, cosio2, eccsq, omeosq, posq, rp, rteosq, sinio;
+    initl(el.epochDs50UTC, sat.ecco, sat.inclo, el.no, ainv, ao, sat.con41, con42,
+          cosio, cosio2, eccsq, omeosq, posq, rp, rteosq, sinio, sat.gsto, sat.noUnkozai);
+
+    if (sat.ecco < 0.0 || sat.ecco >= 1.0) {
+        return SGP4_ERR_ECCENTRICITY;
+    }
+    if (sat.noUnkozai <= 0.0) {
+        return SGP4_ERR_MEAN_MOTION;
+    }
+
+    sat.a = pow(sat.noUnkozai * SGP4_TUMIN, -X2O3);
+    sat.alta = sat.a * (1.0 + sat.ecco) - 1.0;
+    sat.altp = sat.a * (1.0 - sat.ecco) - 1.0;
+
+    // Perigee below 220 km uses the truncated drag model
+    sat.isimp = (rp < (220.0 / SGP4_RADIUS_KM + 1.0)) ? 1 : 0;
+
+    double sfour = ss;
+    double qzms24 = qzms2t;
+    double perige = (rp - 1.0) * SGP4_RADIUS_KM;
+
+    // For perigees below 156 km, s and qoms2t are altered
+    if (perige < 156.0) {
+        sfour = perige - 78.0;
+        if (perige < 98.0) {
+            sfour = 20.0;
+        }
+        double qzms24temp = (120.0 - sfour) / SGP4_RADIUS_KM;
+        qzms24 = qzms24temp * qzms24temp * qzms24temp * qzms24temp;
+        sfour = sfour / SGP4_RADIUS_KM + 1.0;
+    }
+
+    double pinvsq = 1.0 / posq;
+    double tsi = 1.0 / (ao - sfour);
+    sat.eta = ao * sat.ecco * tsi;
+    double etasq = sat.eta * sat.eta;
+    double eeta = sat.ecco * sat.eta;
+    double psisq = fabs(1.0 - etasq);
+    double coef = qzms24 * pow(tsi, 4.0);
+    double coef1 = coef / pow(psisq, 3.5);
+    double cc2 = coef1 * sat.noUnkozai * (ao * (1.0 + 1.5 * etasq + eeta * (4.0 + etasq)) +
+                 0.375 * SGP4_J2 * tsi / psisq * sat.con41 * (8.0 + 3.0 * etasq * (8.0 + etasq)));
+    sat.cc1 = sat.bstar * cc2;
+    double cc3 = 0.0;
+    if (sat.ecco > 1.0e-4) {
+        cc3 = -2.0 * coef * tsi * SGP4_J3OJ2 * sat.noUnkozai * sinio / sat.ecco;
+    }
+    sat.x1mth2 = 1.0 - cosio2;
+    sat.cc4 = 2.0 * sat.noUnkozai * coef1 * ao * omeosq *
+              (sat.eta * (2.0 + 0.5 * etasq) + sat.ecco * (0.5 + 2.0 * etasq) -
+              SGP4_J2 * tsi / (ao * psisq) * (-3.0 * sat.con41 * (1.0 - 2.0 * eeta + etasq *
+              (1.5 - 0.5 * eeta)) + 0.75 * sat.x1mth2 * (2.0 * etasq - eeta * (1.0 + etasq)) *
+              cos(2.0 * sat.argpo)));
+    sat.cc5 = 2.0 * coef1 * ao * omeosq * (1.0 + 2.75 * (etasq + eeta) + eeta * etasq);
+
+    double cosio4 = cosio2 * cosio2;
+    double temp1 = 1.5 * SGP4_J2 * pinvsq * sat.noUnkozai;
+    double temp2 = 0.5 * temp1 * SGP4_J2 * pinvsq;
+    double temp3 = -0.46875 * SGP4_J4 * pinvsq * pinvsq * sat.noUnkozai;
+    sat.mdot = sat.noUnkozai + 0.5 * temp1 * rteosq * sat.con41 + 0.0625 *
+               temp2 * rteosq * (13.0 - 78.0 * cosio2 + 137.0 * cosio4);
+    sat.argpdot = -0.5 * temp1 * con42 + 0.0625 * temp2 *
+                  (7.0 - 114.0 * cosio2 + 395.0 * cosio4) +
+                  temp3 * (3.0 - 36.0 * cosio2 + 49.0 * cosio4);
+    double xhdot1 = -temp1 * cosio;
+    sat.nodedot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * cosio2) +
+                  2.0 * temp3 * (3.0 - 7.0 * cosio2)) * cosio;
+    double xpidot = sat.argpdot + sat.nodedot;
+    sat.omgcof = sat.bstar * cc3 * cos(sat.argpo);
+    sat.xmcof = 0.0;
+    if (sat.ecco > 1.0e-4) {
+        sat.xmcof = -X2O3 * coef * sat.bstar / eeta;
+    }
+    sat.nodecf = 3.5 * omeosq * xhdot1 * sat.cc1;
+    sat.t2cof = 1.5 * sat.cc1;
+
+    // Avoid a divide by zero for an inclination of 180 degrees
+    if (fabs(cosio + 1.0) > 1.5e-12) {
+        sat.xlcof = -0.25 * SGP4_J3OJ2 * sinio * (3.0 + 5.0 * cosio) / (1.0 + cosio);
+    } else {
+        sat.xlcof = -0.25 * SGP4_J3OJ2 * sinio * (3.0 + 5.0 * cosio) / temp4;
+    }
+    sat.aycof = -0.5 * SGP4_J3OJ2 * sinio;
+    double delmotemp = 1.0 + sat.eta * cos(sat.mo);
+    sat.delmo = delmotemp * delmotemp * delmotemp;
+    sat.sinmao = sin(sat.mo);
+    sat.x7thm1 = 7.0 * cosio2 - 1.0;
+
+    // Deep-space initialization for periods of 225 minutes or more
+    if ((TWOPI / sat.noUnkozai) >= 225.0) {
+        sat.method = 'd';
+        sat.isimp = 1;
+
+        DeepCommon dc{};
+        dscom(el.epochDs50UTC, sat.ecco, sat.argpo, 0.0, sat.inclo, sat.nodeo,
+              sat.noUnkozai, sat, dc);
+        dsinit(sat, dc, xpidot, eccsq);
+    }
+
+    // Higher-order drag terms when the full model applies
+    if (sat.isimp != 1) {
+        double cc1sq = sat.cc1 * sat.cc1;
+        sat.d2 = 4.0 * ao * tsi * cc1sq;
+        double temp = sat.d2 * tsi * sat.cc1 / 3.0;
+        sat.d3 = (17.0 * ao + sfour) * temp;
+        sat.d4 = 0.5 * temp * ao * tsi * (221.0 * ao + 31.0 * sfour) * sat.cc1;
+        sat.t3cof = sat.d2 + 2.0 * cc1sq;
+        sat.t4cof = 0.25 * (3.0 * sat.d3 + sat.cc1 * (12.0 * sat.d2 + 10.0 * cc1sq));
+        sat.t5cof = 0.2 * (3.0 * sat.d4 + 12.0 * sat.cc1 * sat.d3 + 6.0 * sat.d2 * sat.d2 +
+                    15.0 * cc1sq * (2.0 * sat.d2 + cc1sq));
+    }
+
+    // Propagate to epoch once to catch element sets that cannot be evaluated
+    double r[3], v[3];
+    int error = sgp4Propagate(sat, 0.0, r, v);
+    return (error == SGP4_ERR_DECAYED) ? SGP4_OK : error;
+}
+
+void sgp4MarkPending(const TleElements& el, Sgp4Sat& sat) {
+    memset(&sat, 0, sizeof(Sgp4Sat));
+
+    sat.satNum = el.satNum;
+    sat.epochDs50UTC = el.epochDs50UTC;
+    sat.ecco = el.ecc;
+    sat.inclo = el.incl;
+    sat.noUnkozai = el.no;
+    sat.method = 'p';
+}
+
+int sgp4Propagate(const Sgp4Sat& sat, double tsince, double r[3], double v[3]) {
+    const double temp4 = 1.5e-12;
+    double t = tsince;
+
+    if (sgp4IsPending(sat)) {
+        return SGP4_ERR_PENDING;
+    }
+
+    // Secular gravity and atmospheric drag
+    double xmdf = sat.mo + sat.mdot * t;
+    double argpdf = sat.argpo + sat.argpdot * t;
+    double nodedf = sat.nodeo + sat.nodedot * t;
+    double argpm = argpdf;
+    double mm = xmdf;
+    double t2 = t * t;
+    double nodem = nodedf + sat.nodecf * t2;
+    double tempa = 1.0 - sat.cc1 * t;
+    double tempe = sat.bstar * sat.cc4 * t;
+    double templ = sat.t2cof * t2;
+
+    if (sat.isimp != 1) {
+        double delomg = sat.omgcof * t;
+        double delmtemp = 1.0 + sat.eta * cos(xmdf);
+        double delm = sat.xmcof * (delmtemp * delmtemp * delmtemp - sat.delmo);
+        double temp = delomg + delm;
+        mm = xmdf + temp;
+        argpm = argpdf - temp;
+        double t3 = t2 * t;
+        double t4 = t3 * t;
+        tempa = tempa - sat.d2 * t2 - sat.d3 * t3 - sat.d4 * t4;
+        tempe = tempe + sat.bstar * sat.cc5 * (sin(mm) - sat.sinmao);
+        templ = templ + sat.t3cof * t3 + t4 * (sat.t4cof + t * sat.t5cof);
+    }
+
+    double nm = sat.noUnkozai;
+    double em = sat.ecco;
+    double inclm = sat.inclo;
+    if (sat.method == 'd') {
+        dspace(sat, t, em, argpm, inclm, mm, nodem, nm);
+    }
+
+    if (nm <= 0.0) {
+        return SGP4_ERR_MEAN_MOTION;
+    }
+
+    double am = pow((SGP4_XKE / nm), X2O3) * tempa * tempa;
+    nm = SGP4_XKE / pow(am, 1.5);
+    em = em - tempe;
+
+    if ((em >= 1.0) || (em < -0.001)) {
+        return SGP4_ERR_ECCENTRICITY;
+    }
+    if (em < 1.0e-6) {
+        em = 1.0e-6;
+    }
+
+    mm = mm + sat.noUnkozai * templ;
+    double xlm = mm + argpm + nodem;
+    nodem = fmod(nodem, TWOPI);
+    argpm = fmod(argpm, TWOPI);
+    xlm = fmod(xlm, TWOPI);
+    mm = fmod(xlm - argpm - nodem, TWOPI);
+
+    // Lunar-solar periodics
+    double ep = em;
+    double xincp = inclm;
+    double argpp = argpm;
+    double nodep = nodem;
+    double mp = mm;
+    double sinip = sin(inclm);
+    double cosip = cos(inclm);
+    double aycof = sat.aycof;
+    double xlcof = sat.xlcof;
+    double con41 = sat.con41;
+    double x1mth2 = sat.x1mth2;
+    double x7thm1 = sat.x7thm1;
+
+    if (sat.method == 'd') {
+        dpper(sat, t, ep, xincp, nodep, argpp, mp);
+        if (xincp < 0.0) {
+            xincp = -xincp;
+            nodep = nodep + PI_D;
+            argpp = argpp - PI_D;
+        }
+        if ((ep < 0.0) || (ep > 1.0)) {
+            return SGP4_ERR_PERTURBED_E;
+        }
+
+        sinip = sin(xincp);
+        cosip = cos(xincp);
+        aycof = -0.5 * SGP4_J3OJ2 * sinip;
+        if (fabs(cosip + 1.0) > 1.5e-12) {
+            xlcof = -0.25 * SGP4_J3OJ2 * sinip * (3.0 + 5.0 * cosip) / (1.0 + cosip);
+        } else {
+            xlcof = -0.25 * SGP4_J3OJ2 * sinip * (3.0 + 5.0 * cosip) / temp4;
+        }
+    }
+
+    // Long period periodics
+    double axnl = ep * cos(argpp);
+    double temp = 1.0 / (am * (1.0 - ep * ep));
+    double aynl = ep * sin(argpp) + temp * aycof;
+    double xl = mp + argpp + nodep + temp * xlcof * axnl;
+
+    // Solve Kepler's equation
+    double u = fmod(xl - nodep, TWOPI);
+    double eo1 = u;
+    double tem5 = 9999.9;
+    double sineo1 = 0.0, coseo1 = 0.0;
+    for (int ktr = 1; fabs(tem5) >= 1.0e-12 && ktr <= 10; ktr++) {
+        sineo1 = sin(eo1);
+        coseo1 = cos(eo1);
+        tem5 = 1.0 - coseo1 * axnl - sineo1 * aynl;
+        tem5 = (u - aynl * coseo1 + axnl * sineo1 - eo1) / tem5;
+        if (fabs(tem5) >= 0.95) {
+            tem5 = tem5 > 0.0 ? 0.95 : -0.95;
+        }
+        eo1 = eo1 + tem5;
+    }
+
+    // Short period preliminary quantities
+    double ecose = axnl * coseo1 + aynl * sineo1;
+    double esine = axnl * sineo1 - aynl * coseo1;
+    double el2 = axnl * axnl + aynl * aynl;
+    double pl = am * (1.0 - el2);
+    if (pl < 0.0) {
+        return SGP4_ERR_SEMILATUS;
+    }
+
+    double rl = am * (1.0 - ecose);
+    double rdotl = sqrt(am) * esine / rl;
+    double rvdotl = sqrt(pl) / rl;
+    double betal = sqrt(1.0 - el2);
+    temp = esine / (1.0 + betal);
+    double sinu = am / rl * (sineo1 - aynl - axnl * temp);
+    double cosu = am / rl * (coseo1 - axnl + aynl * temp);
+    double su = atan2(sinu, cosu);
+    double sin2u = (cosu + cosu) * sinu;
+    double cos2u = 1.0 - 2.0 * sinu * sinu;
+    temp = 1.0 / pl;
+    double temp1 = 0.5 * SGP4_J2 * temp;
+    double temp2 = temp1 * temp;
+
+    if (sat.method == 'd') {
+        double cosisq = cosip * cosip;
+        con41 = 3.0 * cosisq - 1.0;
+        x1mth2 = 1.0 - cosisq;
+        x7thm1 = 7.0 * cosisq - 1.0;
+    }
+
+    // Update for short period periodics
+    double mrt = rl * (1.0 - 1.5 * temp2 * betal * con41) + 0.5 * temp1 * x1mth2 * cos2u;
+    su = su - 0.25 * temp2 * x7thm1 * sin2u;
+    double xnode = nodep + 1.5 * temp2 * cosip * sin2u;
+    double xinc = xincp + 1.5 * temp2 * cosip * sinip * cos2u;
+    double mvt = rdotl - nm * temp1 * x1mth2 * sin2u / SGP4_XKE;
+    double rvdot = rvdotl + nm * temp1 * (x1mth2 * cos2u + 1.5 * con41) / SGP4_XKE;
+
+    // Orientation vectors
+    double sinsu = sin(su);
+    double cossu = cos(su);
+    double snod = sin(xnode);
+    double cnod = cos(xnode);
+    double sini = sin(xinc);
+    double cosi = cos(xinc);
+    double xmx = -snod * cosi;
+    double xmy = cnod * cosi;
+    double ux = xmx * sinsu + cnod * cossu;
+    double uy = xmy * sinsu + snod * cossu;
+    double uz = sini * sinsu;
+    double vx = xmx * cossu - cnod * sinsu;
+    double vy = xmy * cossu - snod * sinsu;
+    double vz = sini * cossu;
+
+    // Position (km) and velocity (km/s)
+    r[0] = (mrt * ux) * SGP4_RADIUS_KM;
+    r[1] = (mrt * uy) * SGP4_RADIUS_KM;
+    r[2] = (mrt * uz) * SGP4_RADIUS_KM;
+    v[0] = (mvt * ux + rvdot * vx) * SGP4_VKMPERSEC;
+    v[1] = (mvt * uy + rvdot * vy) * SGP4_VKMPERSEC;
+    v[2] = (mvt * uz + rvdot * vz) * SGP4_VKMPERSEC;
+
+    if (mrt < 1.0) {
+        return SGP4_ERR_DECAYED;
+    }
+
+    return SGP4_OK;
+}
@@ -0,0 +1,476 @@
+/****************************************************************/
+/*                           Sgp4Batch                          */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        Structure-of-arrays SGP4 kernel. Each block holds     */
+/*        SGP4_BATCH_LANES near-earth satellites; every stage   */
+/*        is written as a loop over lanes with no calls or      */
+/*        data-dependent branches so the compiler emits AVX2 /  */
+/*        AVX-512 (or NEON) code. The simplified drag model is  */
+/*        folded in by zeroing its coefficients, so lanes never */
+/*        diverge. Deep-space objects stay on the scalar path.  */
+/****************************************************************/
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <vector>
+
+#include "Sgp4.h"
+#include "Sgp4Batch.h"
+
+namespace {
+
+const double PI_D   = 3.14159265358979323846;
+const double TWOPI  = 2.0 * PI_D;
+const double X2O3   = 2.0 / 3.0;
+
+// Adding and subtracting 1.5 * 2^52 rounds to the nearest integer without a libm call
+const double ROUND_MAGIC = 6755399441055744.0;
+
+// laneOfSlot entry for render slots the batch does not cover
+const int NO_LANE = INT_MIN;
+
+inline double roundNearest(double x) {
+    return (x + ROUND_MAGIC) - ROUND_MAGIC;
+}
+
+// Reduce an angle to [-pi, pi]
+inline double wrapAngle(double x) {
+    return x - roundNearest(x * (1.0 / TWOPI)) * TWOPI;
+}
+
+// sin and cos with a three-part Cody-Waite reduction by pi/2 and the
+// fdlibm kernel polynomials; accurate to a few ulp for |x| < 2^20
+inline void batchSinCos(double x, double& s, double& c) {
+    const double pio2_1 = 1.57079632673412561417e+00;
+    const double pio2_2 = 6.07710050630396597660e-11;
+    const double pio2_3 = 2.02226624871116645580e-21;
+    const double S1 = -1.66666666666666324348e-01;
+    const double S2 =  8.33333333332248946124e-03;
+    const double S3 = -1.98412698298579493134e-04;
+    const double S4 =  2.75573137070700676789e-06;
+    const double S5 = -2.50507602534068634195e-08;
+    const double S6 =  1.58969099521155010221e-10;
+    const double C1 =  4.16666666666666019037e-02;
+    const double C2 = -1.38888888888741095749e-03;
+    const double C3 =  2.48015872894767294178e-05;
+    const double C4 = -2.75573143513906633035e-07;
+    const double C5 =  2.08757232129817482790e-09;
+    const double C6 = -1.13596475577881948265e-11;
+
+    double q = roundNearest(x * (2.0 / PI_D));
+    int iq = static_cast<int>(q);
+    double r = ((x - q * pio2_1) - q * pio2_2) - q * pio2_3;
+    double z = r * r;
+
+    double sr = r + r * z * (S1 + z * (S2 + z * (S3 + z * (S4 + z * (S5 + z * S6)))));
+    double cr = 1.0 - 0.5 * z + z * z * (C1 + z * (C2 + z * (C3 + z * (C4 + z * (C5 + z * C6)))));
+
+    // Select by quadrant
+    bool swap = (iq & 1) != 0;
+    double sv = swap ? cr : sr;
+    double cv = swap ? sr : cr;
+    s = (iq & 2) ? -sv : sv;
+    c = ((iq + 1) & 2) ? -cv : cv;
+}
+
+// atan2 using the Cephes rational approximation on [0, 0.66] with one reduction step
+inline double batchAtan2(double y, double x) {
+    const double P0 = -8.750608600031904122785e-01;
+    const double P1 = -1.615753718733365076637e+01;
+    const double P2 = -7.500855792314704667340e+01;
+    const double P3 = -1.228866684490136173410e+02;
+    const double P4 = -6.485021904942025371773e+01;
+    const double Q0 =  2.485846490142306297962e+01;
+    const double Q1 =  1.650270098316988542046e+02;
+    const double Q2 =  4.328810604912902668951e+02;
+    const double Q3 =  4.853903996359136964868e+02;
+    const double Q4 =  1.945506571482613964425e+02;
+    const double MOREBITS = 6.123233995736765886130e-17;
+
+    double ay = fabs(y);
+    double ax = fabs(x);
+    bool steep = ay > ax;
+    double hi = steep ? ay : ax;
+    double lo = steep ? ax : ay;
+    double a = lo / (hi > 0.0 ? hi : 1.0);
+
+    // Divisions are unconditional so the selects below stay branch-free
+    bool reduce = a > 0.66;
+    double reduced = (a - 1.0) / (a + 1.0);
+    double w = reduce ? reduced : a;
+    double zz = w * w;
+    double p = (((P0 * zz + P1) * zz + P2) * zz + P3) * zz + P4;
+    double q = ((((zz + Q0) * zz + Q1) * zz + Q2) * zz + Q3) * zz + Q4;
+    double r = w * (zz * p / q) + w;
+    r = reduce ? (PI_D / 4.0) + (r + 0.5 * MOREBITS) : r;
+
+    r = steep ? (PI_D / 2.0) - r : r;
+    r = (x < 0.0) ? PI_D - r : r;
+    return (y < 0.0) ? -r : r;
+}
+
+} // namespace
+
+void Sgp4Batch::build(const vector<Sgp4Sat>& sats, const vector<int>& slots, int chunkSlots) {
+    const int L = SGP4_BATCH_LANES;
+
+    // Assign every satellite to the chunk that owns its render slot
+    numChunks = 1;
+    vector<int> chunk(sats.size(), 0);
+    if (chunkSlots > 0) {
+        for (int i = 0; i < (int)sats.size(); i++) {
+            chunk[i] = slots[i] / chunkSlots;
+            numChunks = max(numChunks, chunk[i] + 1);
+        }
+    }
+
+    // Bucket by chunk, then by propagation model; each chunk's near-earth
+    // satellites are padded to a whole number of blocks
+    vector<vector<int>> nearByChunk(numChunks), deepByChunk(numChunks);
+    for (int i = 0; i < (int)sats.size(); i++) {
+        // Pending objects get no lane; their points are left as they are
+        if (sgp4IsPending(sats[i])) {
+            continue;
+        }
+
+        if (sats[i].method == 'd') {
+            deepByChunk[chunk[i]].push_back(i);
+        } else {
+            nearByChunk[chunk[i]].push_back(i);
+        }
+    }
+
+    vector<int> nearIdx;
+    chunkBlocks.assign(numChunks + 1, 0);
+    chunkDeep.assign(numChunks + 1, 0);
+    deepSats.clear();
+    deepSlots.clear();
+    numNearEarth = 0;
+
+    for (int c = 0; c < numChunks; c++) {
+        const vector<int>& near = nearByChunk[c];
+        int blocks = (near.size() + L - 1) / L;
+
+        for (int k = 0; k < blocks * L; k++) {
+            // Padding lanes repeat the chunk's last satellite and are never written back
+            nearIdx.push_back(k < (int)near.size() ? near[k] : -1 - near.back());
+        }
+        for (int i : deepByChunk[c]) {
+            deepSats.push_back(sats[i]);
+            deepSlots.push_back(slots[i]);
+        }
+
+        numNearEarth += near.size();
+        chunkBlocks[c + 1] = chunkBlocks[c] + blocks;
+        chunkDeep[c + 1] = deepSats.size();
+    }
+
+    numBlocks = chunkBlocks[numChunks];
+    int padded = numBlocks * L;
+
+    vector<double>* fields[] = {
+        &epoch, &mo, &mdot, &argpo, &argpdot, &nodeo, &nodedot, &nodecf,
+        &cc1, &bcc4, &bcc5, &t2cof, &t3cof, &t4cof, &t5cof, &d2, &d3, &d4,
+        &omgcof, &xmcof, &eta, &delmo, &sinmao,
+        &noUnkozai, &aoFactor, &ecco, &inclo, &sinio, &cosio,
+        &aycof, &xlcof, &con41, &x1mth2, &x7thm1
+    };
+    for (vector<double>* field : fields) {
+        field->assign(padded, 0.0);
+    }
+    slot.assign(padded, -1);
+
+    // Where each render slot lives: lane k >= 0 or deep-space entry -1 - d
+    int maxSlot = -1;
+    for (int i = 0; i < (int)sats.size(); i++) {
+        maxSlot = max(maxSlot, slots[i]);
+    }
+    laneOfSlot.assign(maxSlot + 1, NO_LANE);
+    for (int d = 0; d < (int)deepSlots.size(); d++) {
+        laneOfSlot[deepSlots[d]] = -1 - d;
+    }
+
+    for (int k = 0; k < padded; k++) {
+        bool padding = nearIdx[k] < 0;
+
+        slot[k] = padding ? -1 : slots[nearIdx[k]];
+        fillLane(k, sats[padding ? -1 - nearIdx[k] : nearIdx[k]]);
+
+        if (!padding) {
+            laneOfSlot[slot[k]] = k;
+        }
+    }
+}
+
+bool Sgp4Batch::replace(int s, const Sgp4Sat& sat) {
+    if (s < 0 || s >= (int)laneOfSlot.size()) {
+        return false;
+    }
+
+    int k = laneOfSlot[s];
+    bool deep = k < 0;
+
+    if (k == NO_LANE) {
+        return false;
+    }
+
+    // Moving between buckets changes the block layout
+    if (deep != (sat.method == 'd') || sgp4IsPending(sat)) {
+        return false;
+    }
+
+    if (deep) {
+        deepSats[-1 - k] = sat;
+    } else {
+        fillLane(k, sat);
+    }
+
+    return true;
+}
+
+void Sgp4Batch::fillLane(int k, const Sgp4Sat& s) {
+    bool full = (s.isimp != 1);
+
+    epoch[k] = s.epochDs50UTC;
+    mo[k] = s.mo;
+    mdot[k] = s.mdot;
+    argpo[k] = s.argpo;
+    argpdot[k] = s.argpdot;
+    nodeo[k] = s.nodeo;
+    nodedot[k] = s.nodedot;
+    nodecf[k] = s.nodecf;
+    cc1[k] = s.cc1;
+    bcc4[k] = s.bstar * s.cc4;
+    t2cof[k] = s.t2cof;
+
+    // Terms only present in the full drag model
+    bcc5[k] = full ? s.bstar * s.cc5 : 0.0;
+    t3cof[k] = full ? s.t3cof : 0.0;
+    t4cof[k] = full ? s.t4cof : 0.0;
+    t5cof[k] = full ? s.t5cof : 0.0;
+    d2[k] = full ? s.d2 : 0.0;
+    d3[k] = full ? s.d3 : 0.0;
+    d4[k] = full ? s.d4 : 0.0;
+    omgcof[k] = full ? s.omgcof : 0.0;
+    xmcof[k] = full ? s.xmcof : 0.0;
+    eta[k] = s.eta;
+    delmo[k] = s.delmo;
+    sinmao[k] = s.sinmao;
+
+    noUnkozai[k] = s.noUnkozai;
+    aoFactor[k] = pow(SGP4_XKE / s.noUnkozai, X2O3);
+    ecco[k] = s.ecco;
+    inclo[k] = s.inclo;
+    sinio[k] = sin(s.inclo);
+    cosio[k] = cos(s.inclo);
+    aycof[k] = s.aycof;
+    xlcof[k] = s.xlcof;
+    con41[k] = s.con41;
+    x1mth2[k] = s.x1mth2;
+    x7thm1[k] = s.x7thm1;
+}
+
+void Sgp4Batch::propagate(double ds50UTC, GLfloat* points, double kmPerUnit) const {
+    for (int c = 0; c < numChunks; c++) {
+        propagateChunk(c, ds50UTC, points, kmPerUnit);
+    }
+}
+
+void Sgp4Batch::propagateChunk(int c, double ds50UTC, GLfloat* points, double kmPerUnit) const {
+    for (int b = chunkBlocks[c]; b < chunkBlocks[c + 1]; b++) {
+        propagateBlock(b, ds50UTC, points, kmPerUnit);
+    }
+
+    double r[3], v[3];
+    for (int i = chunkDeep[c]; i < chunkDeep[c + 1]; i++) {
+        int error = sgp4PropagateDs50(deepSats[i], ds50UTC, r, v);
+        if (error == SGP4_OK || error == SGP4_ERR_DECAYED) {
+            int s = deepSlots[i];
+            points[s * 3] = r[0] / kmPerUnit;
+            points[s * 3 + 1] = r[2] / kmPerUnit;
+            points[s * 3 + 2] = r[1] / kmPerUnit;
+        }
+    }
+}
+
+void Sgp4Batch::propagateBlock(int b, double ds50UTC, GLfloat* points, double kmPerUnit) const {
+    const int L = SGP4_BATCH_LANES;
+    const int base = b * L;
+
+    const double* __restrict pEpoch = &epoch[base];
+    const double* __restrict pMo = &mo[base];
+    const double* __restrict pMdot = &mdot[base];
+    const double* __restrict pArgpo = &argpo[base];
+    const double* __restrict pArgpdot = &argpdot[base];
+    const double* __restrict pNodeo = &nodeo[base];
+    const double* __restrict pNodedot = &nodedot[base];
+    const double* __restrict pNodecf = &nodecf[base];
+    const double* __restrict pCc1 = &cc1[base];
+    const double* __restrict pBcc4 = &bcc4[base];
+    const double* __restrict pBcc5 = &bcc5[base];
+    const double* __restrict pT2cof = &t2cof[base];
+    const double* __restrict pT3cof = &t3cof[base];
+    const double* __restrict pT4cof = &t4cof[base];
+    const double* __restrict pT5cof = &t5cof[base];
+    const double* __restrict pD2 = &d2[base];
+    const double* __restrict pD3 = &d3[base];
+    const double* __restrict pD4 = &d4[base];
+    const double* __restrict pOmgcof = &omgcof[base];
+    const double* __restrict pXmcof = &xmcof[base];
+    const double* __restrict pEta = &eta[base];
+    const double* __restrict pDelmo = &delmo[base];
+    const double* __restrict pSinmao = &sinmao[base];
+    const double* __restrict pNo = &noUnkozai[base];
+    const double* __restrict pAo = &aoFactor[base];
+    const double* __restrict pEcco = &ecco[base];
+    const double* __restrict pInclo = &inclo[base];
+    const double* __restrict pSinio = &sinio[base];
+    const double* __restrict pCosio = &cosio[base];
+    const double* __restrict pAycof = &aycof[base];
+    const double* __restrict pXlcof = &xlcof[base];
+    const double* __restrict pCon41 = &con41[base];
+    const double* __restrict pX1mth2 = &x1mth2[base];
+    const double* __restrict pX7thm1 = &x7thm1[base];
+
+    alignas(64) double am[L], nodem[L], axnl[L], aynl[L], u[L];
+    alignas(64) double eo1[L], sineo1[L], coseo1[L];
+    alignas(64) double rx[L], ry[L], rz[L];
+    alignas(64) double ok[L], done[L];
+
+    // Secular gravity, drag and long period periodics
+    for (int l = 0; l < L; l++) {
+        double t = (ds50UTC - pEpoch[l]) * 1440.0;
+        double xmdf = pMo[l] + pMdot[l] * t;
+        double argpdf = pArgpo[l] + pArgpdot[l] * t;
+        double nodedf = pNodeo[l] + pNodedot[l] * t;
+        double t2 = t * t;
+        double t3 = t2 * t;
+        double t4 = t3 * t;
+        double node = nodedf + pNodecf[l] * t2;
+
+        double sinx, cosx;
+        batchSinCos(xmdf, sinx, cosx);
+        double delomg = pOmgcof[l] * t;
+        double delmtemp = 1.0 + pEta[l] * cosx;
+        double delm = pXmcof[l] * (delmtemp * delmtemp * delmtemp - pDelmo[l]);
+        double temp = delomg + delm;
+        double mm = xmdf + temp;
+        double argpm = argpdf - temp;
+
+        double sinmm, cosmm;
+        batchSinCos(mm, sinmm, cosmm);
+        double tempa = 1.0 - pCc1[l] * t - pD2[l] * t2 - pD3[l] * t3 - pD4[l] * t4;
+        double tempe = pBcc4[l] * t + pBcc5[l] * (sinmm - pSinmao[l]);
+        double templ = pT2cof[l] * t2 + pT3cof[l] * t3 + t4 * (pT4cof[l] + t * pT5cof[l]);
+
+        double a = pAo[l] * tempa * tempa;
+        double em = pEcco[l] - tempe;
+        ok[l] = (em < 1.0 && em >= -0.001) ? 1.0 : 0.0;
+        em = em < 1.0e-6 ? 1.0e-6 : em;
+
+        mm = mm + pNo[l] * templ;
+        double xlm = mm + argpm + node;
+        node = wrapAngle(node);
+        argpm = wrapAngle(argpm);
+        xlm = wrapAngle(xlm);
+        mm = wrapAngle(xlm - argpm - node);
+
+        double sinw, cosw;
+        batchSinCos(argpm, sinw, cosw);
+        double ax = em * cosw;
+        temp = 1.0 / (a * (1.0 - em * em));
+        double ay = em * sinw + temp * pAycof[l];
+        double xl = mm + argpm + node + temp * pXlcof[l] * ax;
+
+        am[l] = a;
+        nodem[l] = node;
+        axnl[l] = ax;
+        aynl[l] = ay;
+        u[l] = wrapAngle(xl - node);
+        eo1[l] = u[l];
+        done[l] = 0.0;
+    }
+
+    // Kepler's equation; converged lanes are frozen until every lane is done.
+    // Masks are doubles so the selects share a vector width with the data.
+    for (int ktr = 0; ktr < 10; ktr++) {
+#if defined(__GNUC__)
+#pragma GCC unroll 1
+#endif
+        for (int l = 0; l < L; l++) {
+            double s, c;
+            batchSinCos(eo1[l], s, c);
+            double tem5 = 1.0 - c * axnl[l] - s * aynl[l];
+            tem5 = (u[l] - aynl[l] * c + axnl[l] * s - eo1[l]) / tem5;
+            tem5 = tem5 > 0.95 ? 0.95 : tem5;
+            tem5 = tem5 < -0.95 ? -0.95 : tem5;
+
+            bool frozen = done[l] != 0.0;
+            sineo1[l] = frozen ? sineo1[l] : s;
+            coseo1[l] = frozen ? coseo1[l] : c;
+            eo1[l] = frozen ? eo1[l] : eo1[l] + tem5;
+            done[l] = (frozen || fabs(tem5) < 1.0e-12) ? 1.0 : 0.0;
+        }
+
+        double converged = 1.0;
+        for (int l = 0; l < L; l++) {
+            converged = converged < done[l] ? converged : done[l];
+        }
+        if (converged != 0.0) {
+            break;
+        }
+    }
+
+    // Short period periodics and position
+    for (int l = 0; l < L; l++) {
+        double a = am[l];
+        double ecose = axnl[l] * coseo1[l] + aynl[l] * sineo1[l];
+        double esine = axnl[l] * sineo1[l] - aynl[l] * coseo1[l];
+        double el2 = axnl[l] * axnl[l] + aynl[l] * aynl[l];
+        double pl = a * (1.0 - el2);
+        ok[l] = pl >= 0.0 ? ok[l] : 0.0;
+
+        double rl = a * (1.0 - ecose);
+        double betal = sqrt(1.0 - el2);
+        double temp = esine / (1.0 + betal);
+        double sinu = a / rl * (sineo1[l] - aynl[l] - axnl[l] * temp);
+        double cosu = a / rl * (coseo1[l] - axnl[l] + aynl[l] * temp);
+        double su = batchAtan2(sinu, cosu);
+        double sin2u = (cosu + cosu) * sinu;
+        double cos2u = 1.0 - 2.0 * sinu * sinu;
+        temp = 1.0 / pl;
+        double temp1 = 0.5 * SGP4_J2 * temp;
+        double temp2 = temp1 * temp;
+
+        double mrt = rl * (1.0 - 1.5 * temp2 * betal * pCon41[l]) + 0.5 * temp1 * pX1mth2[l] * cos2u;
+        su = su - 0.25 * temp2 * pX7thm1[l] * sin2u;
+        double xnode = nodem[l] + 1.5 * temp2 * pCosio[l] * sin2u;
+        double xinc = pInclo[l] + 1.5 * temp2 * pCosio[l] * pSinio[l] * cos2u;
+
+        double sinsu, cossu, snod, cnod, sini, cosi;
+        batchSinCos(su, sinsu, cossu);
+        batchSinCos(xnode, snod, cnod);
+        batchSinCos(xinc, sini, cosi);
+        double xmx = -snod * cosi;
+        double xmy = cnod * cosi;
+
+        double scale = mrt * SGP4_RADIUS_KM / kmPerUnit;
+        rx[l] = (xmx * sinsu + cnod * cossu) * scale;
+        ry[l] = (xmy * sinsu + snod * cossu) * scale;
+        rz[l] = (sini * sinsu) * scale;
+    }
+
+    // Scatter into render slots, skipping padding and failed lanes
+    const int* blockSlots = &slot[base];
+    for (int l = 0; l < L; l++) {
+        int s = blockSlots[l];
+        if (s >= 0 && ok[l] != 0.0) {
+            points[s * 3] = rx[l];
+            points[s * 3 + 1] = rz[l];
+            points[s * 3 + 2] = ry[l];
+        }
+    }
+}
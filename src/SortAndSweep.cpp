@@ -0,0 +1,146 @@
+/****************************************************************/
+/*                          SortAndSweep                        */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        The sort is the parallel radix sort on the sweep      */
+/*        coordinate; the sweep splits the sorted objects into  */
+/*        chunks that each scan their own windows, so both      */
+/*        halves spread over the worker pool.                   */
+/****************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "SortAndSweep.h"
+#include "RadixSort.h"
+
+using namespace std;
+
+namespace {
+
+// Sorted objects per sweep task
+const int SWEEP_CHUNK = 4096;
+
+double coordinate(const SpaceDebris& debris, int axis) {
+    return axis == 0 ? debris.x : (axis == 1 ? debris.y : debris.z);
+}
+
+} // namespace
+
+SortAndSweep::SortAndSweep(const vector<SpaceDebris>& debris_list, double tolerance, ThreadPool* pool) {
+    this->debris_list = debris_list;
+    this->tolerance = tolerance;
+    this->pool = pool;
+
+    int n = debris_list.size();
+
+    // The axis the objects are most spread along leaves the fewest in each window
+    double sum[3] = {0.0, 0.0, 0.0};
+    double sumSquares[3] = {0.0, 0.0, 0.0};
+    for (const auto& debris : debris_list) {
+        for (int a = 0; a < 3; a++) {
+            double v = coordinate(debris, a);
+            sum[a] += v;
+            sumSquares[a] += v * v;
+        }
+    }
+
+    axis = 0;
+    double bestVariance = -1.0;
+    for (int a = 0; a < 3; a++) {
+        double mean = n > 0 ? sum[a] / n : 0.0;
+        double variance = n > 0 ? sumSquares[a] / n - mean * mean : 0.0;
+        if (variance > bestVariance) {
+            bestVariance = variance;
+            axis = a;
+        }
+    }
+
+    vector<uint64_t> keys(n);
+    order.resize(n);
+    for (int i = 0; i < n; i++) {
+        keys[i] = sortableKey(coordinate(debris_list[i], axis));
+        order[i] = i;
+    }
+
+    radixSort(keys, order, pool);
+
+    sweep.resize(n + SWEEP_LANES);
+    other1.resize(n + SWEEP_LANES);
+    other2.resize(n + SWEEP_LANES);
+    for (int i = 0; i < n; i++) {
+        const SpaceDebris& debris = debris_list[order[i]];
+        sweep[i] = coordinate(debris, axis);
+        other1[i] = coordinate(debris, (axis + 1) % 3);
+        other2[i] = coordinate(debris, (axis + 2) % 3);
+    }
+    for (int i = n; i < n + SWEEP_LANES; i++) {
+        sweep[i] = numeric_limits<double>::infinity();
+        other1[i] = 0.0;
+        other2[i] = 0.0;
+    }
+}
+
+// Test sorted objects [begin, end) against the objects after them within tolerance on the sweep axis
+void SortAndSweep::sweep_range(int begin, int end, vector<DebrisPair>& pairs) const {
+    double tolerance2 = tolerance * tolerance;
+
+    for (int i = begin; i < end; i++) {
+        double s = sweep[i];
+        double a = other1[i];
+        double b = other2[i];
+        double limit = s + tolerance;
+
+        for (int j = i + 1; sweep[j] <= limit; j += SWEEP_LANES) {
+            const double* __restrict pS = &sweep[j];
+            const double* __restrict pA = &other1[j];
+            const double* __restrict pB = &other2[j];
+
+            // Whole block at once; entries past the window are dropped below
+            double dist2[SWEEP_LANES];
+            for (int l = 0; l < SWEEP_LANES; l++) {
+                double ds = pS[l] - s;
+                double da = pA[l] - a;
+                double db = pB[l] - b;
+                dist2[l] = ds * ds + da * da + db * db;
+            }
+
+            for (int l = 0; l < SWEEP_LANES; l++) {
+                if (pS[l] <= limit && is_risky_pair(dist2[l], tolerance2)) {
+                    pairs.push_back({order[i], order[j + l], sqrt(dist2[l])});
+                }
+            }
+        }
+    }
+}
+
+void SortAndSweep::find_pairs(vector<DebrisPair>& pairs) const {
+    int n = order.size();
+    int numChunks = (n + SWEEP_CHUNK - 1) / SWEEP_CHUNK;
+    vector<vector<DebrisPair>> chunkPairs(numChunks);
+
+    auto task = [&](int c) {
+        sweep_range(c * SWEEP_CHUNK, min(n, (c + 1) * SWEEP_CHUNK), chunkPairs[c]);
+    };
+
+    if (pool != nullptr) {
+        pool->run(numChunks, task);
+    } else {
+        for (int c = 0; c < numChunks; c++) {
+            task(c);
+        }
+    }
+
+    for (const vector<DebrisPair>& found : chunkPairs) {
+        pairs.insert(pairs.end(), found.begin(), found.end());
+    }
+}
+
+void SortAndSweep::find_risky_debris(vector<SpaceDebris>& riskList) const {
+    vector<DebrisPair> pairs;
+    find_pairs(pairs);
+
+    risk_list_from_pairs(debris_list, pairs, riskList);
+}
@@ -3,9 +3,10 @@
 /*                                                              */
 /*            Blake Owen, Bryant Woolsey, Marco Wehrhahn        */
 /*                                                              */
-/*        This source code contains the two algorithms we       */
-/*        developed for solving the risk assessment for         */
-/*        satellite and debris data read from TLE files.        */
+/*        This source code contains the iterative risk          */
+/*        assessment for satellite and debris data read from    */
+/*        TLE files, and the helpers the spatial screeners      */
+/*        share. The octree lives in LinearOctree.              */
 /****************************************************************/
 
 #include <iostream>
@@ -22,110 +23,6 @@
 
 using namespace std;
 
-// Octree solution
-Octree::Octree(vector<SpaceDebris>& debris_list, double tolerance) {
-    this->debris_list = debris_list;
-
-    OctNode* newRoot = new OctNode();
-
-    root = newRoot;
-
-    double min_x, min_y, min_z, max_x, max_y, max_z;
-
-    min_x = min_y = min_z = numeric_limits<double>::max();
-
-    max_x = max_y = max_z = numeric_limits<double>::lowest();
-    
-    // Set initial bounds of octree to the maximum volume
-    for (const auto& debris : debris_list) {
-        min_x = min(min_x, debris.x);
-        max_x = max(max_x, debris.x);
-        min_y = min(min_y, debris.y);
-        max_y = max(max_y, debris.y);
-        min_z = min(min_z, debris.z);
-        max_z = max(max_z, debris.z);
-    }
-
-    for (int i = 0; i < debris_list.size(); i++) {
-      insert(root, debris_list.at(i), min_x, max_x, min_y, max_y, min_z, max_z, tolerance);
-    }
-}
-
-void Octree::insert(OctNode* node, SpaceDebris& debris, double x_min, double x_max, double y_min, double y_max, double z_min, double z_max, double& tolerance) {
-    // Insert node and return if tolerance is met
-    if (x_max - x_min <= tolerance) {
-      node->idList.push_back(debris);
-      return;
-    }
-
-    // Otherwise, segment new octree and calculate quadrant from coordinates
-    double x_mid = (x_min + x_max) / 2;
-
-    double y_mid = (y_min + y_max) / 2;
-
-    double z_mid = (z_min + z_max) / 2;
-
-    int child_index = 0;
-
-    // Convert x, y, z coordinates to quadrant
-    bitset<3> quadrant = {0};
-    if (debris.x > x_mid)
-      quadrant[0] = 1;
-    if (debris.y > y_mid)
-      quadrant[1] = 1;
-    if (debris.z > z_mid)
-      quadrant[2] = 1;
-
-    // Convert bitset to integer index
-    child_index = quadrant.to_ulong();
-
-    // If no node at new quadrant, create new octree
-    if (!node->children[child_index]) {
-      node->children[child_index] = new OctNode();
-    }
-
-    // Calculate octree bounds
-    double new_x_min = quadrant[0] ? x_mid : x_min;
-    double new_x_max = quadrant[0] ? x_max : x_mid;
-    double new_y_min = quadrant[1] ? y_mid : y_min;
-    double new_y_max = quadrant[1] ? y_max : y_mid;
-    double new_z_min = quadrant[2] ? z_mid : z_min;
-    double new_z_max = quadrant[2] ? z_max : z_mid;
-
-    // Recursively traverse octree to construct
-    insert(node->children[child_index], debris, new_x_min, new_x_max, new_y_min, new_y_max, new_z_min, new_z_max, tolerance);
-}
-
-// Traverse constructed octree and find nodes with multiple values
-// This would be any debris closer together than the specified tolerance
-void Octree::find_risky(OctNode* node, vector<SpaceDebris>& riskList) {
-  if (node == nullptr) {
-    return;
-  } else if (node->idList.size() > 1) {
-    for (int i = 0; i < node->idList.size() - 1; i++) {
-      
-      // Save id and distance data for future sorting
-      double dist = node->idList.at(i).distance(node->idList.at(i + 1));
-
-      if (dist > 0.0) {
-        node->idList.at(i).riskyOther = node->idList.at(i + 1).id;
-        node->idList.at(i).riskDistance = dist;
-        riskList.push_back(node->idList.at(i));
-      }
-    }
-  }
-
-  // Traverse octree
-  for (int i = 0; i < 8; i++) {
-    find_risky(node->children[i], riskList);
-  }
-}
-
-// Procedure to call to calculate the riskList
-void Octree::find_risky_debris(vector<SpaceDebris>& riskList) {
-  find_risky(root, riskList);
-}
-
 // Iterative solution
 vector<SpaceDebris> find_local_optimum(vector<SpaceDebris>& debris_list, double tolerance, int iterations) {
     vector<SpaceDebris> result;
@@ -151,6 +48,32 @@ vector<SpaceDebris> find_local_optimum(vector<SpaceDebris>& debris_list, double
     return result;
 }
 
+// Collapse a pair list into the risk list the UI shows
+void risk_list_from_pairs(const vector<SpaceDebris>& debris_list, const vector<DebrisPair>& pairs, vector<SpaceDebris>& riskList) {
+    vector<int> closest(debris_list.size(), -1);
+    vector<double> closestDistance(debris_list.size(), numeric_limits<double>::max());
+
+    for (const DebrisPair& pair : pairs) {
+      if (pair.distance < closestDistance[pair.first]) {
+        closest[pair.first] = pair.second;
+        closestDistance[pair.first] = pair.distance;
+      }
+      if (pair.distance < closestDistance[pair.second]) {
+        closest[pair.second] = pair.first;
+        closestDistance[pair.second] = pair.distance;
+      }
+    }
+
+    for (int i = 0; i < debris_list.size(); i++) {
+      if (closest[i] >= 0) {
+        SpaceDebris entry = debris_list.at(i);
+        entry.riskyOther = debris_list.at(closest[i]).id;
+        entry.riskDistance = closestDistance[i];
+        riskList.push_back(entry);
+      }
+    }
+}
+
 // Comparison procedures for sorting
 bool compareDebrisDistanceLess(SpaceDebris d1, SpaceDebris d2) {
     return (d1.riskDistance < d2.riskDistance);
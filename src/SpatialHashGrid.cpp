@@ -0,0 +1,174 @@
+/****************************************************************/
+/*                        SpatialHashGrid                       */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        Build: count objects per cell with linear probing,    */
+/*        prefix-sum the counts and scatter the objects so      */
+/*        each cell's positions are contiguous. Search: each    */
+/*        cell against itself and 13 of its neighbours, so      */
+/*        every pair of adjacent cells is visited once.         */
+/****************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "SpatialHashGrid.h"
+
+using namespace std;
+
+namespace {
+
+const int CELL_BITS = 21;
+const uint32_t CELL_MAX = (1u << CELL_BITS) - 1;
+const uint64_t EMPTY_CELL = ~0ULL;
+
+uint64_t packCell(uint64_t x, uint64_t y, uint64_t z) {
+    return x | y << CELL_BITS | z << (2 * CELL_BITS);
+}
+
+} // namespace
+
+SpatialHashGrid::SpatialHashGrid(const vector<SpaceDebris>& debris_list, double tolerance) {
+    this->debris_list = debris_list;
+    this->tolerance = tolerance;
+
+    int n = debris_list.size();
+
+    double min_x, min_y, min_z, max_x, max_y, max_z;
+
+    min_x = min_y = min_z = numeric_limits<double>::max();
+
+    max_x = max_y = max_z = numeric_limits<double>::lowest();
+
+    for (const auto& debris : debris_list) {
+        min_x = min(min_x, debris.x);
+        max_x = max(max_x, debris.x);
+        min_y = min(min_y, debris.y);
+        max_y = max(max_y, debris.y);
+        min_z = min(min_z, debris.z);
+        max_z = max(max_z, debris.z);
+    }
+
+    // Cells no narrower than the tolerance, so a pair is always in the same or adjacent cells
+    double extent = n > 0 ? max(max_x - min_x, max(max_y - min_y, max_z - min_z)) : 0.0;
+    cellSize = max(max(tolerance, extent / CELL_MAX), numeric_limits<double>::min());
+
+    int bits = 1;
+    while ((1 << bits) < 2 * n) {
+        bits++;
+    }
+    table.assign(1 << bits, {EMPTY_CELL, 0, 0});
+    shift = 64 - bits;
+    numCells = 0;
+
+    // Count objects per cell, remembering each object's slot for the scatter
+    vector<int> slotOf(n);
+    for (int i = 0; i < n; i++) {
+        const SpaceDebris& debris = debris_list[i];
+        uint64_t cx = min((uint32_t)((debris.x - min_x) / cellSize), CELL_MAX);
+        uint64_t cy = min((uint32_t)((debris.y - min_y) / cellSize), CELL_MAX);
+        uint64_t cz = min((uint32_t)((debris.z - min_z) / cellSize), CELL_MAX);
+        uint64_t key = packCell(cx, cy, cz);
+
+        int slot = find_slot(key);
+        if (table[slot].key == EMPTY_CELL) {
+            table[slot].key = key;
+            numCells++;
+        }
+        table[slot].count++;
+        slotOf[i] = slot;
+    }
+
+    // Cells hand out their ranges as they fill; start is moved back afterwards
+    int offset = 0;
+    for (Cell& cell : table) {
+        cell.start = offset;
+        offset += cell.count;
+    }
+
+    points.resize(n);
+    for (int i = 0; i < n; i++) {
+        Cell& cell = table[slotOf[i]];
+        points[cell.start++] = {debris_list[i].x, debris_list[i].y, debris_list[i].z, i};
+    }
+    for (Cell& cell : table) {
+        cell.start -= cell.count;
+    }
+}
+
+// Slot holding key, or the empty slot where it would go
+int SpatialHashGrid::find_slot(uint64_t key) const {
+    size_t mask = table.size() - 1;
+    size_t slot = (key * 0x9e3779b97f4a7c15ULL) >> shift;
+
+    while (table[slot].key != EMPTY_CELL && table[slot].key != key) {
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+// Compare the objects of cell a with those of cell b, or with each other when same
+void SpatialHashGrid::compare_cells(const Cell& a, const Cell& b, bool same, vector<DebrisPair>& pairs) const {
+    double tolerance2 = tolerance * tolerance;
+
+    for (int i = a.start; i < a.start + a.count; i++) {
+        const Point& p = points[i];
+        int first = same ? i + 1 : b.start;
+
+        for (int j = first; j < b.start + b.count; j++) {
+            const Point& q = points[j];
+            double dx = p.x - q.x;
+            double dy = p.y - q.y;
+            double dz = p.z - q.z;
+            double dist2 = dx * dx + dy * dy + dz * dz;
+
+            if (is_risky_pair(dist2, tolerance2)) {
+                pairs.push_back({p.index, q.index, sqrt(dist2)});
+            }
+        }
+    }
+}
+
+void SpatialHashGrid::find_pairs(vector<DebrisPair>& pairs) const {
+    // Half of the 26 neighbours; the other half see this cell in their own stencil
+    static const int offsets[13][3] = {
+        {1, 0, 0}, {-1, 1, 0}, {0, 1, 0}, {1, 1, 0},
+        {-1, -1, 1}, {0, -1, 1}, {1, -1, 1}, {-1, 0, 1}, {0, 0, 1}, {1, 0, 1}, {-1, 1, 1}, {0, 1, 1}, {1, 1, 1}
+    };
+
+    for (const Cell& cell : table) {
+        if (cell.key == EMPTY_CELL) {
+            continue;
+        }
+
+        compare_cells(cell, cell, true, pairs);
+
+        int64_t cx = cell.key & CELL_MAX;
+        int64_t cy = (cell.key >> CELL_BITS) & CELL_MAX;
+        int64_t cz = cell.key >> (2 * CELL_BITS);
+
+        for (const auto& offset : offsets) {
+            int64_t nx = cx + offset[0];
+            int64_t ny = cy + offset[1];
+            int64_t nz = cz + offset[2];
+            if (nx < 0 || ny < 0 || nz < 0 || nx > CELL_MAX || ny > CELL_MAX || nz > CELL_MAX) {
+                continue;
+            }
+
+            const Cell& neighbour = table[find_slot(packCell(nx, ny, nz))];
+            if (neighbour.key != EMPTY_CELL) {
+                compare_cells(cell, neighbour, false, pairs);
+            }
+        }
+    }
+}
+
+void SpatialHashGrid::find_risky_debris(vector<SpaceDebris>& riskList) const {
+    vector<DebrisPair> pairs;
+    find_pairs(pairs);
+
+    risk_list_from_pairs(debris_list, pairs, riskList);
+}
@@ -0,0 +1,228 @@
+/****************************************************************/
+/*                        StartupProfiler                       */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        getrusage on POSIX, GetProcessTimes and               */
+/*        GetProcessMemoryInfo on Windows.                      */
+/****************************************************************/
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "StartupProfiler.h"
+
+namespace {
+
+// Open phases on the calling thread, for indenting nested ones
+thread_local int openPhases = 0;
+
+string jsonEscape(const string& text) {
+    string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+} // namespace
+
+double processCpuMs() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return 0.0;
+    }
+
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) / 1e4;   // 100 ns ticks
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0.0;
+    }
+
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e3
+         + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e3;
+#endif
+}
+
+double peakRssMb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0.0;
+    }
+    return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0.0;
+    }
+
+    // Bytes on macOS, kilobytes elsewhere
+#ifdef __APPLE__
+    return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+    return usage.ru_maxrss / 1024.0;
+#endif
+#endif
+}
+
+StartupProfiler::StartupProfiler() {
+    created = chrono::steady_clock::now();
+    ownerThread = this_thread::get_id();
+    cpuStartMs = processCpuMs();
+}
+
+StartupProfiler::Phase::Phase(StartupProfiler* profiler, const char* name) : profiler(profiler) {
+    index = profiler ? profiler->begin(name) : -1;
+}
+
+StartupProfiler::Phase::~Phase() {
+    stop();
+}
+
+void StartupProfiler::Phase::stop() {
+    if (profiler) {
+        profiler->end(index, count);
+        profiler = nullptr;
+    }
+}
+
+int StartupProfiler::begin(const char* name) {
+    double cpu = processCpuMs();
+    double start = chrono::duration<double, milli>(chrono::steady_clock::now() - created).count();
+
+    lock_guard<mutex> guard(lock);
+    Record record;
+    record.name = name;
+    record.depth = openPhases++;
+    record.background = this_thread::get_id() != ownerThread;
+    record.startMs = start;
+    record.wallMs = 0.0;
+    record.cpuMs = 0.0;
+    record.count = -1;
+    record.peakRssMb = 0.0;
+    record.done = false;
+    records.push_back(record);
+    cpuAtStart.push_back(cpu);
+    return records.size() - 1;
+}
+
+void StartupProfiler::end(int index, long long count) {
+    double cpu = processCpuMs();
+    double now = chrono::duration<double, milli>(chrono::steady_clock::now() - created).count();
+    double rss = peakRssMb();
+
+    lock_guard<mutex> guard(lock);
+    openPhases--;
+
+    Record& record = records[index];
+    record.wallMs = now - record.startMs;
+    record.cpuMs = cpu - cpuAtStart[index];
+    record.count = count;
+    record.peakRssMb = rss;
+    record.done = true;
+}
+
+void StartupProfiler::finish() {
+    {
+        lock_guard<mutex> guard(lock);
+        if (finished) {
+            return;
+        }
+        finished = true;
+    }
+
+    printTable(std::cout);
+
+    if (!jsonFile.empty() && !writeJson(jsonFile)) {
+        std::cout << "[ERROR]: Unable to write startup profile " << jsonFile << std::endl;
+    }
+}
+
+void StartupProfiler::printTable(ostream& out) {
+    double totalMs = chrono::duration<double, milli>(chrono::steady_clock::now() - created).count();
+    double totalCpuMs = processCpuMs() - cpuStartMs;
+    double rss = peakRssMb();
+
+    lock_guard<mutex> guard(lock);
+
+    const int nameWidth = 36;
+    out << "[Startup] " << std::left << std::setw(nameWidth) << "Phase" << std::right
+        << std::setw(11) << "Wall ms" << std::setw(11) << "CPU ms" << std::setw(10) << "Count"
+        << std::setw(13) << "Peak RSS MB" << std::endl;
+
+    out << std::fixed << std::setprecision(1);
+    for (const Record& record : records) {
+        string name = string(record.depth * 2, ' ') + record.name + (record.background ? " (background)" : "");
+
+        out << "[Startup] " << std::left << std::setw(nameWidth) << name << std::right;
+        if (record.done) {
+            out << std::setw(11) << record.wallMs << std::setw(11) << record.cpuMs;
+        } else {
+            out << std::setw(11) << "running" << std::setw(11) << "-";
+        }
+
+        if (record.count >= 0) {
+            out << std::setw(10) << record.count;
+        } else {
+            out << std::setw(10) << "-";
+        }
+
+        out << std::setw(13) << (record.done ? record.peakRssMb : rss) << std::endl;
+    }
+
+    out << "[Startup] " << std::left << std::setw(nameWidth) << "Total" << std::right
+        << std::setw(11) << totalMs << std::setw(11) << totalCpuMs << std::setw(10) << "-"
+        << std::setw(13) << rss << std::defaultfloat << std::endl;
+}
+
+bool StartupProfiler::writeJson(const string& fileName) {
+    double totalMs = chrono::duration<double, milli>(chrono::steady_clock::now() - created).count();
+    double totalCpuMs = processCpuMs() - cpuStartMs;
+    double rss = peakRssMb();
+
+    ofstream out(fileName);
+    if (!out) {
+        return false;
+    }
+
+    lock_guard<mutex> guard(lock);
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\n  \"totalWallMs\": " << totalMs << ",\n  \"totalCpuMs\": " << totalCpuMs
+        << ",\n  \"peakRssMb\": " << rss << ",\n  \"phases\": [";
+
+    for (size_t i = 0; i < records.size(); i++) {
+        const Record& record = records[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << jsonEscape(record.name) << "\""
+            << ", \"depth\": " << record.depth
+            << ", \"background\": " << (record.background ? "true" : "false")
+            << ", \"startMs\": " << record.startMs
+            << ", \"wallMs\": " << record.wallMs
+            << ", \"cpuMs\": " << record.cpuMs
+            << ", \"count\": " << record.count
+            << ", \"peakRssMb\": " << record.peakRssMb
+            << ", \"done\": " << (record.done ? "true" : "false") << "}";
+    }
+
+    out << "\n  ]\n}\n";
+    return (bool)out;
+}
@@ -3,22 +3,491 @@
 /*                                                              */
 /*                           Blake Owen                         */
 /*                                                              */
-/*        This implementation uses the US SpaceForce publicly   */
-/*        released SGP4 propagation libraries for reading and   */
-/*        propagating TLE debris and satellite objects.         */
+/*        This implementation uses the in-tree SGP4 propagator  */
+/*        (Sgp4.h) or the US SpaceForce publicly released SGP4  */
+/*        propagation libraries for reading and propagating     */
+/*        TLE debris and satellite objects.                     */
 /****************************************************************/
 
 #include <vector>
 #include <chrono>
+#include <cmath>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
-#include <unordered_set>
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+#include <mutex>
+#include <algorithm>
 
 #include "gl.h"
 #include "TLEReader.h"
 #include "SpaceDebris.h"
+#include "Sgp4.h"
+#include "SatelliteCatalog.h"
+#include "PropagationBackend.h"
+#include "MappedFile.h"
+#include "TleParser.h"
+#include "FileList.h"
+#include "OmmReader.h"
+
+namespace {
+
+// Binary image of the parsed and initialized native catalog, next to the TLE files
+const char* SNAPSHOT_FILE = "catalog.snap";
+
+// Element sets that failed to initialize, one per line, written next to the snapshot
+const char* QUARANTINE_FILE = "quarantine.txt";
+
+const vector<string> DEFAULT_SOURCES = {"2023_332.txt", "2023_337.txt", "2023_338.txt"};
+
+const double BYTES_PER_MB = 1024.0 * 1024.0;
+
+// Objects per sgp4Init task on the worker pool, and per batch the init thread publishes
+const int INIT_CHUNK_OBJECTS = 256;
+const int INIT_BATCH_OBJECTS = 16384;
+
+const char* sgp4ErrorName(int error) {
+    switch (error) {
+        case SGP4_ERR_ECCENTRICITY: return "mean eccentricity out of range";
+        case SGP4_ERR_MEAN_MOTION:  return "negative mean motion";
+        case SGP4_ERR_PERTURBED_E:  return "perturbed eccentricity out of range";
+        case SGP4_ERR_SEMILATUS:    return "negative semi-latus rectum";
+        case SGP4_ERR_DECAYED:      return "decayed";
+        default:                    return "unknown SGP4 error";
+    }
+}
+
+// Field by field; the padding after satNum is not compared
+bool sameElements(const TleElements& a, const TleElements& b) {
+    return a.satNum == b.satNum && a.epochDs50UTC == b.epochDs50UTC && a.bstar == b.bstar && a.ndot == b.ndot &&
+           a.nddot == b.nddot && a.incl == b.incl && a.raan == b.raan && a.ecc == b.ecc && a.argp == b.argp &&
+           a.mo == b.mo && a.no == b.no;
+}
+
+} // namespace
+
+TLEReader::~TLEReader() {
+    stopInit.store(true);
+
+    if (initThread.joinable()) {
+        initThread.join();
+    }
+}
+
+const vector<string>& TLEReader::sourceList() const {
+    return sources.empty() ? DEFAULT_SOURCES : sources;
+}
 
 GLfloat* TLEReader::ReadFiles(int& numSats, double& epoch, vector<SpaceDebris>& debris) {
+    if (filter.usesAge()) {
+        double today = floor(time(nullptr) / 86400.0) + calendarToDs50(1970, 1, 1, 0, 0, 0.0);
+        filter.setReferenceTime(analysisTime != SELECT_NEWEST_EPOCH ? analysisTime : today);
+    }
+
+    vector<string> fileNames;
+    for (const string& source : sourceList()) {
+        if (!expandPath(source, fileNames)) {
+            std::cout << "[ERROR]: No TLE files found for " << source << std::endl;
+        }
+    }
+
+    vector<const char*> files;
+    for (const string& fileName : fileNames) {
+        files.push_back(fileName.c_str());
+    }
+
+    bool astroStandards = !useNativeSgp4 || benchmarkBackends;
+
+    int numLoaded = 0;
+    if (useNativeSgp4) {
+        numLoaded = loadNative(files, epoch);
+    }
+    if (astroStandards) {
+        double dllEpoch;
+        int numDll = loadAstroStandards(files, dllEpoch);
+
+        if (!useNativeSgp4) {
+            numLoaded = numDll;
+            epoch = dllEpoch;
+        }
+    }
+
+    std::cout << numLoaded << std::endl;
+
+    // With both propagators loaded, pair each native element set with the DLL key
+    // of the same NORAD id; both loaders already kept one set per object by the same rule
+    unordered_map<int, __int64> keyById;
+    if (useNativeSgp4 && astroStandards) {
+        for (__int64 key : satKeys) {
+            keyById.emplace(getKeySatNum(key), key);
+        }
+    }
+
+    // Compact the unique objects into the catalog; NORAD ids are parsed here only
+    catalog.clear();
+    for (int i = 0; i < numLoaded; i++) {
+        int satId = getSatNum(i);
+        __int64 key = 0;
+
+        if (!useNativeSgp4) {
+            key = satKeys[i];
+        } else if (keyById.find(satId) != keyById.end()) {
+            key = keyById[satId];
+        }
+
+        catalog.add(key, i, satId);
+    }
+
+    {
+        StartupProfiler::Phase phase(profiler, "Create backends");
+        createBackends(astroStandards);
+        phase.setCount(catalog.size());
+    }
+    if (benchmarkBackends) {
+        StartupProfiler::Phase phase(profiler, "Benchmark backends");
+        timeBackends(epoch);
+        phase.setCount(backends.size());
+    }
+
+    numSats = catalog.size();
+    GLfloat* points = allocatePoints(numSats);
+
+    // Pending objects keep the zeroed point, inside the Earth, until they are published
+    StartupProfiler::Phase phase(profiler, "Initial propagate");
+    phase.setCount(numSats);
+
+    double pos[3];
+    for (const CatalogEntry& entry : catalog) {
+        int error = getBackend()->position(entry, epoch, pos);
+        if (error == SGP4_ERR_PENDING || error == BACKEND_ERR_NO_KEY) {
+            continue;
+        }
+
+        points[entry.slot * 3] = pos[0] / earthRadiusKm;
+        points[entry.slot * 3 + 1] = pos[2] / earthRadiusKm;
+        points[entry.slot * 3 + 2] = pos[1] / earthRadiusKm;
+
+        debris.push_back(SpaceDebris(entry.noradId, pos[0] / earthRadiusKm, pos[2] / earthRadiusKm, pos[1] / earthRadiusKm));
+    }
+
+    if (initializing.load()) {
+        initThread = thread(&TLEReader::initializeCatalog, this);
+    }
+
+    return points;
+}
+
+void TLEReader::createBackends(bool astroStandards) {
+    backends.clear();
+    nativeBackend = nullptr;
+    adaptive.reset();
+    backendMs.clear();
+    backendIndex = 0;
+
+    if (useNativeSgp4) {
+        if (useParallel && pool == nullptr) {
+            pool.reset(new ThreadPool());
+        }
+
+        // Catalog entries are in slot order
+        vector<int> slotIds;
+        activeSats.clear();
+        activeElements.clear();
+        for (const CatalogEntry& entry : catalog) {
+            activeSats.push_back(nativeRecords[entry.source]);
+            activeElements.push_back(nativeElementRecords[entry.source]);
+            slotIds.push_back(entry.noradId);
+        }
+
+        if (useHistory) {
+            history.bind(slotIds, analysisTime);
+        }
+
+        {
+            lock_guard<mutex> guard(contextLock);
+            context = PropagatorContext(make_shared<const vector<Sgp4Sat>>(activeSats));
+            contextStale = false;
+        }
+
+        nativeBackend = new NativeBackend(activeSats, useParallel ? pool.get() : nullptr);
+        backends.emplace_back(nativeBackend);
+        adaptive.reset(new AdaptiveScheduler(activeSats, useParallel ? pool.get() : nullptr));
+    }
+
+    if (astroStandards) {
+        backends.emplace_back(new Ds50UtcBackend(catalog));
+        backends.emplace_back(new Ds50UtcPosBackend(catalog));
+        backends.emplace_back(new AllSatsBackend(catalog));
+    }
+}
+
+// Time a few full catalog passes per backend and select the fastest
+void TLEReader::timeBackends(double time) {
+    const int passes = 3;
+    GLfloat* scratch = allocatePoints(catalog.size());
+
+    backendMs.assign(backends.size(), 0.0);
+
+    for (int b = 0; b < (int)backends.size(); b++) {
+        // Warm up caches and lazily initialized DLL state
+        backends[b]->propagateAll(time, scratch, earthRadiusKm);
+
+        auto start = chrono::steady_clock::now();
+        for (int k = 0; k < passes; k++) {
+            backends[b]->propagateAll(time + k / 1440.0, scratch, earthRadiusKm);
+        }
+        backendMs[b] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / passes;
+
+        // A backend that skips objects is timed on less work and would draw an incomplete
+        // catalog, so it is reported but never selected
+        int numMissing = backends[b]->missingCount();
+        if (numMissing == 0 && backendMs[b] < backendMs[backendIndex]) {
+            backendIndex = b;
+        }
+
+        std::cout << "[Backend] " << backends[b]->name() << ": " << std::fixed << std::setprecision(3)
+                  << backendMs[b] << " ms";
+        if (numMissing > 0) {
+            std::cout << " (" << numMissing << " objects without a DLL key skipped)";
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << std::defaultfloat << "[Backend] Using " << backends[backendIndex]->name() << std::endl;
+
+    freePoints(scratch);
+}
+
+// Read every element set in a TLE/3LE file or a CCSDS OMM (KVN, CSV or XML) document.
+// TLE files are memory-mapped and parsed in place, in parallel chunks when given workers.
+// Returns the bytes read.
+size_t TLEReader::readTleFile(const char* fileName, vector<TleElements>& elements, ThreadPool* workers) {
+    // CCSDS OMM documents stream through their own reader
+    const CatalogFilter* accept = filter.isEmpty() ? nullptr : &filter;
+
+    OmmFormat format = detectOmmFile(fileName);
+    if (format != OMM_NONE) {
+        OmmReadStats stats = readOmmFile(fileName, format, elements, accept);
+        numFiltered += stats.filtered;
+
+        if (stats.rejected > 0 || stats.bytes == 0) {
+            std::cout << "[ERROR]: Skipped " << stats.rejected << " OMM messages in " << fileName
+                      << ", first: " << stats.firstError << std::endl;
+        } else if (stats.sets + stats.filtered == 0) {
+            std::cout << "[ERROR]: No OMM messages found in " << fileName << std::endl;
+        }
+
+        return stats.bytes;
+    }
+
+    MappedFile file;
+
+    if (!file.open(fileName)) {
+        std::cout << "[ERROR]: Unable to open TLE file " << fileName << std::endl;
+        return 0;
+    }
+
+    TleParseStats stats = parseTleBuffer(file.data(), file.size(), elements, workers, accept);
+    numFiltered += stats.filtered;
+
+    if (stats.malformed > 0 || stats.badChecksum > 0) {
+        std::cout << "[ERROR]: Skipped " << stats.malformed << " malformed and " << stats.badChecksum
+                  << " checksum-failed element sets in " << fileName << ", first: "
+                  << string(stats.firstError, stats.firstErrorLength) << std::endl;
+    }
+
+    return file.size();
+}
+
+// Read every file and append the element sets in file order. With enough files to keep
+// every worker busy, each worker parses whole files; otherwise each file is split into
+// chunks across the workers. Reports every file as it finishes, then the totals.
+void TLEReader::readTleFiles(const vector<const char*>& files, vector<TleElements>& elements) {
+    int numFiles = files.size();
+    ThreadPool* workers = useParallel ? pool.get() : nullptr;
+    bool acrossFiles = workers != nullptr && numFiles >= workers->size();
+
+    vector<vector<TleElements>> perFile(numFiles);
+    vector<size_t> bytes(numFiles, 0);
+    mutex reportLock;
+    int finished = 0;
+    numFiltered.store(0);
+
+    auto load = [&](int f) {
+        auto start = chrono::steady_clock::now();
+        bytes[f] = readTleFile(files[f], perFile[f], acrossFiles ? nullptr : workers);
+        double seconds = max(chrono::duration<double>(chrono::steady_clock::now() - start).count(), 1e-9);
+
+        lock_guard<mutex> guard(reportLock);
+        finished++;
+        std::cout << "[Load] (" << finished << "/" << numFiles << ") " << files[f] << ": " << perFile[f].size()
+                  << " sets, " << std::fixed << std::setprecision(2) << bytes[f] / BYTES_PER_MB << " MB in "
+                  << seconds * 1000.0 << " ms (" << std::setprecision(0) << perFile[f].size() / seconds
+                  << " objects/s, " << std::setprecision(1) << bytes[f] / BYTES_PER_MB / seconds << " MB/s)"
+                  << std::defaultfloat << std::endl;
+    };
+
+    auto start = chrono::steady_clock::now();
+    if (acrossFiles) {
+        workers->run(numFiles, load);
+    } else {
+        for (int f = 0; f < numFiles; f++) {
+            load(f);
+        }
+    }
+    double seconds = max(chrono::duration<double>(chrono::steady_clock::now() - start).count(), 1e-9);
+
+    size_t totalSets = 0, totalBytes = 0;
+    for (int f = 0; f < numFiles; f++) {
+        totalSets += perFile[f].size();
+        totalBytes += bytes[f];
+    }
+
+    elements.reserve(elements.size() + totalSets);
+    for (vector<TleElements>& sets : perFile) {
+        elements.insert(elements.end(), sets.begin(), sets.end());
+        vector<TleElements>().swap(sets);
+    }
+
+    std::cout << "[Load] " << numFiles << " files, " << totalSets << " sets, " << std::fixed << std::setprecision(2)
+              << totalBytes / BYTES_PER_MB << " MB in " << seconds << " s (" << std::setprecision(0)
+              << totalSets / seconds << " objects/s, " << std::setprecision(1) << totalBytes / BYTES_PER_MB / seconds
+              << " MB/s)" << std::defaultfloat << std::endl;
+
+    if (!filter.isEmpty()) {
+        std::cout << "[Filter] " << filter.text() << ": kept " << totalSets << ", dropped " << numFiltered.load()
+                  << " element sets" << std::endl;
+    }
+}
+
+// Parse and initialize all satellites with the in-tree SGP4 propagator
+int TLEReader::loadNative(const vector<const char*>& files, double& epoch) {
+    uint64_t fingerprint = CatalogSnapshot::sourceFingerprint(files, analysisTime, filter);
+    int numSats = 0;
+
+    bool mapped = false;
+    if (useSnapshot) {
+        StartupProfiler::Phase phase(profiler, "Map snapshot");
+        mapped = snapshot.open(SNAPSHOT_FILE, fingerprint);
+        phase.setCount(mapped ? snapshot.size() : 0);
+    }
+
+    if (mapped) {
+        // Nothing is parsed or initialized; the catalog, history and createBackends() copy the
+        // records out of the mapping
+        nativeSats.clear();
+        nativeElements.clear();
+        nativeRecords = snapshot.sats();
+        nativeElementRecords = snapshot.elements();
+        numSats = snapshot.size();
+
+        if (useHistory) {
+            history.build(snapshot.history(), snapshot.historySize());
+        }
+
+        std::cout << "[Snapshot] Mapped " << numSats << " objects from " << SNAPSHOT_FILE << std::endl;
+    } else {
+        vector<TleElements> parsed;
+
+        if (useParallel && pool == nullptr) {
+            pool.reset(new ThreadPool());
+        }
+
+        {
+            StartupProfiler::Phase phase(profiler, "Parse files");
+            readTleFiles(files, parsed);
+            phase.setCount(parsed.size());
+        }
+
+        if (useHistory) {
+            StartupProfiler::Phase phase(profiler, "Build TLE history");
+            history.build(parsed.data(), parsed.size());
+            phase.setCount(parsed.size());
+        }
+
+        // Overlapping files repeat most objects; only one set per object is initialized
+        vector<int> ids(parsed.size());
+        vector<double> epochs(parsed.size());
+        for (int i = 0; i < (int)parsed.size(); i++) {
+            ids[i] = parsed[i].satNum;
+            epochs[i] = parsed[i].epochDs50UTC;
+        }
+
+        vector<int> survivors = selectElementSets(ids, epochs, analysisTime);
+        std::cout << "[Catalog] Kept " << survivors.size() << " of " << parsed.size() << " element sets" << std::endl;
+
+        vector<TleElements> elements(survivors.size());
+        for (int i = 0; i < (int)survivors.size(); i++) {
+            elements[i] = parsed[survivors[i]];
+        }
+
+        numSats = elements.size();
+
+        nativeSats.resize(numSats);
+
+        // Backend timings need a ready catalog, so benchmarking initializes up front
+        if (lazyInit && !benchmarkBackends) {
+            // Placeholders until initializeCatalog() publishes the real state; the snapshot
+            // is written once every object has been through sgp4Init
+            for (int i = 0; i < numSats; i++) {
+                sgp4MarkPending(elements[i], nativeSats[i]);
+            }
+
+            initSets.swap(parsed);
+            initFingerprint = fingerprint;
+            numPending.store(numSats);
+            initializing.store(true);
+        } else {
+            vector<int> errors(numSats);
+            {
+                StartupProfiler::Phase phase(profiler, "Initialize SGP4");
+                initializeSets(elements.data(), nativeSats.data(), errors.data(), numSats);
+                phase.setCount(numSats);
+            }
+
+            // Sets that cannot be initialized are quarantined and never get a slot
+            int numKept = 0;
+            for (int i = 0; i < numSats; i++) {
+                if (errors[i] != SGP4_OK) {
+                    quarantineSet(elements[i].satNum, elements[i].epochDs50UTC, sgp4ErrorName(errors[i]));
+                    continue;
+                }
+
+                elements[numKept] = elements[i];
+                nativeSats[numKept] = nativeSats[i];
+                numKept++;
+            }
+            elements.resize(numKept);
+            nativeSats.resize(numKept);
+            numSats = numKept;
+
+            reportQuarantine();
+
+            if (useSnapshot) {
+                StartupProfiler::Phase phase(profiler, "Write snapshot");
+                phase.setCount(numSats);
+                if (!CatalogSnapshot::write(SNAPSHOT_FILE, fingerprint, elements, nativeSats, parsed)) {
+                    std::cout << "[ERROR]: Unable to write catalog snapshot " << SNAPSHOT_FILE << std::endl;
+                }
+            }
+        }
+
+        nativeRecords = nativeSats.data();
+        nativeElements.swap(elements);
+        nativeElementRecords = nativeElements.data();
+    }
+
+    epoch = numSats > 0 ? nativeElementRecords[0].epochDs50UTC : 0.0;
+
+    return numSats;
+}
+
+// Load and initialize all satellites through the Astro Standards DLLs
+int TLEReader::loadAstroStandards(const vector<const char*>& files, double& epoch) {
+    StartupProfiler::Phase dllPhase(profiler, "Load Astro Standards DLLs");
+
     // Load MainDll dll
     LoadDllMainDll();
 
@@ -36,84 +505,683 @@ GLfloat* TLEReader::ReadFiles(int& numSats, double& epoch, vector<SpaceDebris>&
 
     // Load Sgp4Prop dll and assign function pointers
     LoadSgp4PropDll();
-
-    vector<const char*> files = {"2023_332.txt", "2023_337.txt", "2023_338.txt"};
+    dllPhase.stop();
     
+    StartupProfiler::Phase loadPhase(profiler, "Sgp4LoadFileAll");
+    loadPhase.setCount(files.size());
     for (const char* file : files) {
+        if (detectOmmFile(file) != OMM_NONE) {
+            std::cout << "[ERROR]: Astro Standards cannot load OMM file " << file << std::endl;
+            continue;
+        }
+
         Sgp4LoadFileAll((char*)file);
     }
+    loadPhase.stop();
     
-    numSats = TleGetCount();
-
-    std::cout << numSats << std::endl;
+    int numSats = TleGetCount();
 
     vector<__int64> constructKeys(numSats);
 
     satKeys = constructKeys;
 
-    TleGetLoaded(2, satKeys.data());
+    {
+        StartupProfiler::Phase phase(profiler, "TleGetLoaded");
+        TleGetLoaded(2, satKeys.data());
+        phase.setCount(numSats);
+    }
+
+    // Keep one element set per object and drop the rest before initialization
+    char valueStr[GETSETSTRLEN] = {'\0'};
+    vector<int> ids(numSats);
+    vector<double> epochs(numSats);
+    for (int i = 0; i < numSats; i++) {
+        ids[i] = getKeySatNum(satKeys[i]);
+
+        TleGetField(satKeys[i], XF_TLE_EPOCH, valueStr);
+        valueStr[GETSETSTRLEN-1] = 0;
+        epochs[i] = DTGToUTC(valueStr);
+    }
+
+    // The library parses whole files, so the filter runs on what it loaded; the sets it
+    // rejects are removed before selection and initialization
+    if (!filter.isEmpty()) {
+        numFiltered.store(0);
+
+        int numKept = 0;
+        for (int i = 0; i < numSats; i++) {
+            int satNum, epochYr, ephType, elsetNum, revNum;
+            char secClass, satName[9] = {'\0'};
+            double epochDays, bstar, incli, node, eccen, omega, mnAnomaly, mnMotion;
+            TleGetAllFieldsGP(satKeys[i], &satNum, &secClass, satName, &epochYr, &epochDays, &bstar, &ephType,
+                              &elsetNum, &incli, &node, &eccen, &omega, &mnAnomaly, &mnMotion, &revNum);
+
+            TleElements el;
+            elementsFromTleUnits(mnMotion, 0.0, 0.0, bstar, incli, node, eccen, omega, mnAnomaly, el);
+            el.satNum = ids[i];
+            el.epochDs50UTC = epochs[i];
+
+            if (!filter.accepts(el)) {
+                TleRemoveSat(satKeys[i]);
+                numFiltered++;
+                continue;
+            }
+
+            satKeys[numKept] = satKeys[i];
+            ids[numKept] = ids[i];
+            epochs[numKept] = epochs[i];
+            numKept++;
+        }
+        satKeys.resize(numKept);
+        ids.resize(numKept);
+        epochs.resize(numKept);
+        numSats = numKept;
+
+        std::cout << "[Filter] " << filter.text() << ": kept " << numSats << ", dropped " << numFiltered.load()
+                  << " element sets" << std::endl;
+    }
 
-    GLfloat* points = new GLfloat[numSats * 3];
+    vector<int> survivors = selectElementSets(ids, epochs, analysisTime);
+    vector<bool> kept(numSats, false);
+    for (int i : survivors) {
+        kept[i] = true;
+    }
+    for (int i = 0; i < numSats; i++) {
+        if (!kept[i]) {
+            TleRemoveSat(satKeys[i]);
+        }
+    }
 
-    TleGetField(satKeys[0], XF_TLE_EPOCH, valueStr);
-    valueStr[GETSETSTRLEN-1] = 0;
-    epoch = DTGToUTC(valueStr);
+    vector<__int64> survivorKeys(survivors.size());
+    for (int i = 0; i < (int)survivors.size(); i++) {
+        survivorKeys[i] = satKeys[survivors[i]];
+    }
+    satKeys = survivorKeys;
+    numSats = satKeys.size();
 
+    epoch = numSats > 0 ? epochs[survivors[0]] : 0.0;
+
+    // The library keeps process-wide state, so this stays serial. Sets it rejects are
+    // quarantined and removed rather than ending the process.
+    StartupProfiler::Phase initPhase(profiler, "Sgp4InitSat");
+    initPhase.setCount(numSats);
+    int numKept = 0;
     for (int i = 0; i < numSats; i++) {
         if (Sgp4InitSat(satKeys[i]) != 0) {
-            ShowMsgAndTerminate();
+            char message[LOGMSGLEN + 1] = {'\0'};
+            GetLastErrMsg(message);
+            message[LOGMSGLEN] = 0;
+
+            string reason = message;
+            reason.erase(reason.find_last_not_of(' ') + 1);
+
+            quarantineSet(ids[survivors[i]], epochs[survivors[i]], reason);
+            TleRemoveSat(satKeys[i]);
+            continue;
         }
 
-        
-        //if (i < 100) {
-            int satId;
-            char strId[512] = {'\0'};
+        satKeys[numKept++] = satKeys[i];
+    }
+    satKeys.resize(numKept);
+    numSats = numKept;
 
-            TleGetField(satKeys[i], XF_TLE_SATNUM, strId);
-            satId = stoi(strId);
+    reportQuarantine();
 
-            if (!isAdded(satId)) {
-                Sgp4PropDs50UTC(satKeys[i], epoch, &mse, pos, vel, llh);
-        
-                SpaceDebris newDebris(i, pos[0] / earthRadiusKm, pos[2] / earthRadiusKm, pos[1] / earthRadiusKm);
-                
-                points[i * 3] = pos[0] / earthRadiusKm;
-                points[i * 3 + 1] = pos[2] / earthRadiusKm;
-                points[i * 3 + 2] = pos[1] / earthRadiusKm;
+    return numSats;
+}
 
-                newDebris.id = satId;
+void TLEReader::getNativeCatalog(vector<Sgp4Sat>& sats, vector<int>& slots) {
+    sats = activeSats;
+    slots.clear();
 
-                debris.push_back(newDebris);
-                addedSet.emplace(newDebris.id);
-                uniqueSats.emplace(i);
+    for (const CatalogEntry& entry : catalog) {
+        slots.push_back(entry.slot);
+    }
+}
+
+void TLEReader::getCatalogElements(vector<TleElements>& elements) {
+    // Switched and published sets are written under contextLock
+    if (useNativeSgp4) {
+        lock_guard<mutex> guard(contextLock);
+        elements = activeElements;
+        return;
+    }
+
+    // Astro Standards keeps the sets in the DLL; read back their orbital elements
+    elements.assign(catalog.size(), TleElements());
+    for (const CatalogEntry& entry : catalog) {
+        int satNum, epochYr, ephType, elsetNum, revNum;
+        char secClass, satName[9] = {'\0'};
+        double epochDays, bstar, incli, node, eccen, omega, mnAnomaly, mnMotion;
+        TleGetAllFieldsGP(entry.satKey, &satNum, &secClass, satName, &epochYr, &epochDays, &bstar, &ephType,
+                          &elsetNum, &incli, &node, &eccen, &omega, &mnAnomaly, &mnMotion, &revNum);
+
+        TleElements& el = elements[entry.slot];
+        elementsFromTleUnits(mnMotion, 0.0, 0.0, bstar, incli, node, eccen, omega, mnAnomaly, el);
+        el.satNum = entry.noradId;
+    }
+}
+
+PropagatorContext TLEReader::getContext() {
+    lock_guard<mutex> guard(contextLock);
+
+    if (contextStale) {
+        context = PropagatorContext(make_shared<const vector<Sgp4Sat>>(activeSats));
+        contextStale = false;
+    }
+
+    return context;
+}
+
+int TLEReader::updateHistory(double time, vector<int>& switchedSlots, vector<Sgp4Sat>& switchedSats) {
+    reloadTime.store(time);
+    int numReloaded = publishReload(time, switchedSlots, switchedSats);
+
+    if (!useNativeSgp4 || !useHistory || nativeBackend == nullptr || !history.hasSwitches()) {
+        return numReloaded;
+    }
+
+    int first = switchedSlots.size();
+    if (history.update(time, switchedSlots) == 0) {
+        return numReloaded;
+    }
+
+    lock_guard<mutex> guard(contextLock);
+
+    vector<int> slots;
+    vector<TleElements> els;
+    vector<Sgp4Sat> sats;
+    for (int i = first; i < (int)switchedSlots.size(); i++) {
+        int slot = switchedSlots[i];
+        const TleElements& el = history.at(history.current(slot));
+        Sgp4Sat sat;
+
+        // A set that fails to initialize leaves the object on its previous one
+        if (sgp4Init(el, sat) == SGP4_OK) {
+            slots.push_back(slot);
+            els.push_back(el);
+            sats.push_back(sat);
+        } else {
+            std::cout << "[ERROR]: SGP4 initialization failed for satellite " << el.satNum << std::endl;
+        }
+    }
+
+    replaceSlots(slots, els, sats);
+
+    for (int i = first; i < (int)switchedSlots.size(); i++) {
+        switchedSats.push_back(activeSats[switchedSlots[i]]);
+    }
+
+    contextStale = true;
+
+    return numReloaded + switchedSlots.size() - first;
+}
+
+// Caller holds contextLock. The batch kernel is rebuilt at most once for all of them.
+void TLEReader::replaceSlots(const vector<int>& slots, const vector<TleElements>& els, const vector<Sgp4Sat>& sats) {
+    for (int i = 0; i < (int)slots.size(); i++) {
+        int slot = slots[i];
+
+        if (sgp4IsPending(activeSats[slot]) && !sgp4IsPending(sats[i])) {
+            numPending--;
+        }
+
+        activeElements[slot] = els[i];
+        activeSats[slot] = sats[i];
+        adaptive->replace(slot, sats[i]);
+    }
+
+    if (!slots.empty()) {
+        nativeBackend->replace(slots, sats);
+    }
+}
+
+// sgp4Init elements[i] into sats[i] for count sets, in chunks across the worker pool;
+// errors[i] receives each result
+void TLEReader::initializeSets(const TleElements* elements, Sgp4Sat* sats, int* errors, int count) {
+    int numChunks = (count + INIT_CHUNK_OBJECTS - 1) / INIT_CHUNK_OBJECTS;
+    auto init = [&](int c) {
+        int last = min(count, (c + 1) * INIT_CHUNK_OBJECTS);
+        for (int i = c * INIT_CHUNK_OBJECTS; i < last; i++) {
+            errors[i] = sgp4Init(elements[i], sats[i]);
+        }
+    };
+
+    if (useParallel && pool != nullptr) {
+        pool->run(numChunks, init);
+    } else {
+        for (int c = 0; c < numChunks; c++) {
+            init(c);
+        }
+    }
+}
+
+// Init thread: set up the pending catalog batch by batch and stage each one for
+// publishReload(), so objects come online between frames once the window is open.
+// nativeSats is not read again after createBackends(), so it is filled in place.
+void TLEReader::initializeCatalog() {
+    auto start = chrono::steady_clock::now();
+    int numSets = nativeElements.size();
+
+    vector<int> slotOf(numSets, -1);
+    for (const CatalogEntry& entry : catalog) {
+        slotOf[entry.source] = entry.slot;
+    }
+
+    vector<int> errors(numSets, SGP4_OK);
+    int numQuarantined = 0;
+    int first = 0;
+
+    // The last batch is staged after the phase ends, so the profile is complete once it is published
+    StartupProfiler::Phase phase(profiler, "Initialize SGP4");
+    CatalogReload last;
+    do {
+        int count = min(INIT_BATCH_OBJECTS, numSets - first);
+        initializeSets(&nativeElements[first], &nativeSats[first], &errors[first], count);
+
+        // A quarantined object stays pending
+        CatalogReload batch;
+        for (int i = first; i < first + count; i++) {
+            if (errors[i] != SGP4_OK) {
+                quarantineSet(nativeElements[i].satNum, nativeElements[i].epochDs50UTC, sgp4ErrorName(errors[i]));
+                numQuarantined++;
+                continue;
             }
-        //}
+
+            batch.slots.push_back(slotOf[i]);
+            batch.elements.push_back(nativeElements[i]);
+            batch.sats.push_back(nativeSats[i]);
+        }
+
+        first += count;
+        batch.initDone = first == numSets;
+        if (batch.initDone) {
+            last = move(batch);
+        } else {
+            stageReload(batch);
+        }
+    } while (first < numSets && !stopInit.load());
+
+    if (first < numSets) {
+        return;
     }
 
-    return points;
+    phase.setCount(numSets - numQuarantined);
+    phase.stop();
+    stageReload(last);
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    std::cout << "[Init] " << numSets - numQuarantined << " objects initialized in " << std::fixed
+              << std::setprecision(2) << seconds << " s" << std::defaultfloat << std::endl;
+    reportQuarantine();
+
+    if (useSnapshot) {
+        StartupProfiler::Phase phase(profiler, "Write snapshot");
+        vector<TleElements> elements;
+        vector<Sgp4Sat> sats;
+        for (int i = 0; i < numSets; i++) {
+            if (errors[i] == SGP4_OK) {
+                elements.push_back(nativeElements[i]);
+                sats.push_back(nativeSats[i]);
+            }
+        }
+
+        if (!CatalogSnapshot::write(SNAPSHOT_FILE, initFingerprint, elements, sats, initSets)) {
+            std::cout << "[ERROR]: Unable to write catalog snapshot " << SNAPSHOT_FILE << std::endl;
+        }
+    }
+
+    vector<TleElements>().swap(initSets);
 }
 
-void TLEReader::propagate(double time, GLfloat* points, int numSats, bool setDebris, vector<SpaceDebris>& debris) {
-    for (int i = 0; i < numSats; i++) {
-        if (uniqueSats.find(i) != uniqueSats.end()) {
-            Sgp4PropDs50UTC(satKeys[i], time, &mse, pos, vel, llh);
+void TLEReader::quarantineSet(int satNum, double epochDs50UTC, const string& reason) {
+    lock_guard<mutex> guard(quarantineLock);
+    quarantine.push_back({satNum, epochDs50UTC, reason});
+}
 
-            points[i * 3] = pos[0] / earthRadiusKm;
-            points[i * 3 + 1] = pos[2] / earthRadiusKm;
-            points[i * 3 + 2] = pos[1] / earthRadiusKm;
+// Summarize the quarantined sets and list them all in QUARANTINE_FILE
+void TLEReader::reportQuarantine() {
+    lock_guard<mutex> guard(quarantineLock);
+    if (quarantine.empty()) {
+        return;
+    }
+
+    ofstream report(QUARANTINE_FILE);
+    for (const QuarantinedSet& set : quarantine) {
+        report << set.satNum << " " << std::fixed << std::setprecision(8) << set.epochDs50UTC << " " << set.reason << "\n";
+    }
+
+    std::cout << "[ERROR]: Quarantined " << quarantine.size() << " element sets that failed to initialize, first: "
+              << quarantine[0].satNum << " (" << quarantine[0].reason << "), all in " << QUARANTINE_FILE << std::endl;
+}
+
+vector<QuarantinedSet> TLEReader::getQuarantine() {
+    lock_guard<mutex> guard(quarantineLock);
+    return quarantine;
+}
+
+int TLEReader::getQuarantinedCount() {
+    lock_guard<mutex> guard(quarantineLock);
+    return quarantine.size();
+}
+
+bool TLEReader::startWatching() {
+    if (!useNativeSgp4 || nativeBackend == nullptr) {
+        std::cout << "[ERROR]: Reloading changed TLE files needs the native SGP4 propagator" << std::endl;
+        return false;
+    }
 
-            if (setDebris) {
-                int satId;
-                char strId[512] = {'\0'};
+    watcher.stop();
 
-                TleGetField(satKeys[i], XF_TLE_SATNUM, strId);
-                satId = stoi(strId);
+    // The watcher thread's own view of the catalog; the live state is only touched on publish
+    reloadSlots.clear();
+    for (const CatalogEntry& entry : catalog) {
+        reloadSlots.emplace(entry.noradId, entry.slot);
+    }
+    reloadElements = activeElements;
+
+    reloadSets.clear();
+    if (useHistory) {
+        reloadSets.reserve(history.size());
+        for (int i = 0; i < history.size(); i++) {
+            reloadSets.push_back(history.at(i));
+        }
+    }
+
+    if (!watcher.start(sourceList(), [this](const vector<string>& files) {reloadFiles(files);})) {
+        std::cout << "[ERROR]: Unable to watch the TLE sources for changes" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Watcher thread: parse the changed files, work out which objects they move to another
+// element set, initialize those and stage the result for publishReload()
+void TLEReader::reloadFiles(const vector<string>& files) {
+    auto start = chrono::steady_clock::now();
+
+    vector<TleElements> parsed;
+    for (const string& file : files) {
+        readTleFile(file.c_str(), parsed, nullptr);
+    }
 
-                SpaceDebris newDebris(i, pos[0] / earthRadiusKm, pos[2] / earthRadiusKm, pos[1] / earthRadiusKm);
-                newDebris.id = satId;
+    int numParsed = parsed.size();
 
-                debris.push_back(newDebris);
+    // Objects that are not on screen need new render slots; they come in at the next start.
+    // Without history, each object's challenger is the set the selection rule prefers.
+    vector<int> touched;
+    unordered_map<int, int> preferredBySlot;
+    int numUnknown = 0;
+    for (int i = 0; i < numParsed; i++) {
+        auto found = reloadSlots.find(parsed[i].satNum);
+        if (found == reloadSlots.end()) {
+            numUnknown++;
+            continue;
+        }
+
+        auto preferred = preferredBySlot.find(found->second);
+        if (preferred == preferredBySlot.end()) {
+            touched.push_back(found->second);
+            preferredBySlot.emplace(found->second, i);
+        } else if (preferEpoch(parsed[i].epochDs50UTC, parsed[preferred->second].epochDs50UTC, analysisTime)) {
+            preferred->second = i;
+        }
+    }
+
+    CatalogReload reload;
+
+    if (useHistory) {
+        // New files first, so a reissued set replaces an old one with the same epoch
+        parsed.insert(parsed.end(), reloadSets.begin(), reloadSets.end());
+        reloadSets.swap(parsed);
+
+        vector<int> slotIds(reloadElements.size());
+        for (const auto& entry : reloadSlots) {
+            slotIds[entry.second] = entry.first;
+        }
+
+        reload.history.reset(new TleHistory());
+        reload.history->build(reloadSets.data(), reloadSets.size());
+        reload.history->bind(slotIds, analysisTime);
+
+        // Prepare the sets each object will want near the current time
+        vector<int> ignored;
+        reload.history->update(reloadTime.load(), ignored);
+
+        for (int slot : touched) {
+            reload.slots.push_back(slot);
+            reload.elements.push_back(reload.history->at(reload.history->current(slot)));
+        }
+    } else {
+        // The reloaded set counts as seen first, so it replaces a current set with the same epoch
+        for (int slot : touched) {
+            const TleElements& candidate = parsed[preferredBySlot[slot]];
+            if (!sameElements(candidate, reloadElements[slot]) &&
+                !preferEpoch(reloadElements[slot].epochDs50UTC, candidate.epochDs50UTC, analysisTime)) {
+                reloadElements[slot] = candidate;
+                reload.slots.push_back(slot);
+                reload.elements.push_back(candidate);
+            }
+        }
+    }
+
+    // A set that fails to initialize is not staged; the object stays on its current one
+    int numStaged = 0;
+    reload.sats.resize(reload.slots.size());
+    for (int i = 0; i < (int)reload.slots.size(); i++) {
+        if (sgp4Init(reload.elements[i], reload.sats[numStaged]) != SGP4_OK) {
+            std::cout << "[ERROR]: SGP4 initialization failed for satellite " << reload.elements[i].satNum << std::endl;
+            continue;
+        }
+
+        reload.slots[numStaged] = reload.slots[i];
+        reload.elements[numStaged] = reload.elements[i];
+        numStaged++;
+    }
+    reload.slots.resize(numStaged);
+    reload.elements.resize(numStaged);
+    reload.sats.resize(numStaged);
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    std::cout << "[Reload] " << files.size() << " files, " << numParsed << " sets, " << numStaged
+              << " objects staged in " << std::fixed << std::setprecision(1) << seconds * 1000.0 << " ms"
+              << std::defaultfloat << std::endl;
+    if (numUnknown > 0) {
+        std::cout << "[Reload] " << numUnknown << " element sets for objects not in the running catalog are loaded at next start" << std::endl;
+    }
+
+    if (reload.slots.empty()) {
+        return;
+    }
+
+    reload.fromFiles = true;
+    stageReload(reload);
+}
+
+// Hand a batch to the propagating thread; one it has not published yet is folded into this one
+void TLEReader::stageReload(CatalogReload& reload) {
+    lock_guard<mutex> guard(reloadLock);
+    if (reload.history != nullptr) {
+        pending.history = move(reload.history);
+    }
+    pending.slots.insert(pending.slots.end(), reload.slots.begin(), reload.slots.end());
+    pending.elements.insert(pending.elements.end(), reload.elements.begin(), reload.elements.end());
+    pending.sats.insert(pending.sats.end(), reload.sats.begin(), reload.sats.end());
+    pending.fromFiles = pending.fromFiles || reload.fromFiles;
+    pending.initDone = pending.initDone || reload.initDone;
+    reloadPending.store(true);
+}
+
+// Propagating thread, between frames: swap in the staged sets. Objects land on the set the
+// live rules pick at time; that is normally the one prepared in the background, and any
+// object whose choice moved in the meantime is initialized here.
+int TLEReader::publishReload(double time, vector<int>& switchedSlots, vector<Sgp4Sat>& switchedSats) {
+    if (!reloadPending.load()) {
+        return 0;
+    }
+
+    CatalogReload reload;
+    {
+        lock_guard<mutex> guard(reloadLock);
+        swap(reload, pending);
+        reloadPending.store(false);
+    }
+
+    if (reload.history != nullptr) {
+        history = move(*reload.history);
+
+        vector<int> ignored;
+        history.update(time, ignored);
+    }
+
+    lock_guard<mutex> guard(contextLock);
+
+    // Later batches come last and win
+    vector<int> slots;
+    vector<TleElements> els;
+    vector<Sgp4Sat> sats;
+    vector<bool> done(activeSats.size(), false);
+    for (int i = (int)reload.slots.size() - 1; i >= 0; i--) {
+        int slot = reload.slots[i];
+        const TleElements* el = useHistory ? &history.at(history.current(slot)) : &reload.elements[i];
+        bool pendingSlot = sgp4IsPending(activeSats[slot]);
+
+        if (done[slot]) {
+            continue;
+        }
+        done[slot] = true;
+
+        if (sameElements(*el, activeElements[slot]) && !pendingSlot) {
+            continue;
+        }
+
+        Sgp4Sat sat;
+        if (!sameElements(*el, reload.elements[i]) && sgp4Init(*el, sat) != SGP4_OK) {
+            std::cout << "[ERROR]: SGP4 initialization failed for satellite " << el->satNum << std::endl;
+
+            // An object still waiting for its first set takes the one prepared for it
+            if (!pendingSlot) {
+                continue;
             }
+            el = &reload.elements[i];
+        }
+        if (sameElements(*el, reload.elements[i])) {
+            sat = reload.sats[i];
+        }
+
+        slots.push_back(slot);
+        els.push_back(*el);
+        sats.push_back(sat);
+    }
+
+    replaceSlots(slots, els, sats);
+    switchedSlots.insert(switchedSlots.end(), slots.begin(), slots.end());
+    switchedSats.insert(switchedSats.end(), sats.begin(), sats.end());
+
+    contextStale = true;
+
+    if (reload.fromFiles) {
+        std::cout << "[Reload] Published " << slots.size() << " updated objects" << std::endl;
+    }
+    if (reload.initDone) {
+        initializing.store(false);
+    }
+
+    return slots.size();
+}
+
+GLfloat* TLEReader::allocatePoints(int numSats) {
+    // Over-allocate and keep the raw pointer just below the aligned block
+    size_t bytes = numSats * 3 * sizeof(GLfloat) + CACHE_LINE_BYTES + sizeof(char*);
+    char* raw = new char[bytes]();
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(raw) + sizeof(char*) + CACHE_LINE_BYTES - 1) & ~(uintptr_t)(CACHE_LINE_BYTES - 1);
+    reinterpret_cast<char**>(aligned)[-1] = raw;
+
+    return reinterpret_cast<GLfloat*>(aligned);
+}
+
+void TLEReader::freePoints(GLfloat* points) {
+    if (points != nullptr) {
+        delete[] reinterpret_cast<char**>(points)[-1];
+    }
+}
+
+int TLEReader::getSatNum(int i) {
+    if (useNativeSgp4) {
+        return nativeRecords[i].satNum;
+    }
+
+    return getKeySatNum(satKeys[i]);
+}
+
+int TLEReader::getKeySatNum(__int64 satKey) {
+    char strId[512] = {'\0'};
+
+    TleGetField(satKey, XF_TLE_SATNUM, strId);
+
+    return stoi(strId);
+}
+
+void TLEReader::propagate(double time, GLfloat* points, int numSats, bool setDebris, vector<SpaceDebris>& debris) {
+    PropagationBackend* backend = getBackend();
+
+    // Every backend writes one point per catalog slot
+    if ((int)catalog.size() > numSats) {
+        std::cout << "[ERROR]: Point buffer holds " << numSats << " objects, catalog has " << catalog.size() << std::endl;
+        return;
+    }
+
+    // Positions only: the backend writes straight into the point buffer
+    if (!setDebris) {
+        if (useAdaptive.load() && adaptive != nullptr) {
+            if (adaptive->getToleranceKm() != adaptiveToleranceKm.load()) {
+                adaptive->setToleranceKm(adaptiveToleranceKm.load());
+            }
+            adaptive->setSimSecondsPerFrame(simSecondsPerFrame.load());
+            adaptive->propagateAll(time, points, earthRadiusKm);
+            propagatedCount.store(adaptive->lastPropagatedCount());
+        } else {
+            backend->propagateAll(time, points, earthRadiusKm);
+            propagatedCount.store(catalog.size() - numPending.load());
+        }
+        return;
+    }
+
+    propagatedCount.store(catalog.size() - numPending.load());
+
+    double pos[3];
+    for (const CatalogEntry& entry : catalog) {
+        int error = backend->position(entry, time, pos);
+        if (error == SGP4_ERR_PENDING || error == BACKEND_ERR_NO_KEY) {
+            continue;
+        }
+
+        points[entry.slot * 3] = pos[0] / earthRadiusKm;
+        points[entry.slot * 3 + 1] = pos[2] / earthRadiusKm;
+        points[entry.slot * 3 + 2] = pos[1] / earthRadiusKm;
+
+        debris.push_back(SpaceDebris(entry.noradId, pos[0] / earthRadiusKm, pos[2] / earthRadiusKm, pos[1] / earthRadiusKm));
+    }
+}
+
+void TLEReader::generateEphemeris(EphemerisTable& table, const vector<int>& slots, double start, double stepMinutes,
+                                  int numSteps, EphemerisLayout layout) {
+    if (useNativeSgp4) {
+        table.generate(getContext(), slots, start, stepMinutes, numSteps, layout, useParallel ? pool.get() : nullptr);
+        return;
+    }
+
+    // Astro Standards: still one satellite at a time across every step
+    PropagationBackend* backend = getBackend();
+    double pos[3];
+    table.resize(slots.size(), start, stepMinutes, numSteps, layout);
+
+    for (int row = 0; row < (int)slots.size(); row++) {
+        const CatalogEntry& entry = catalog[slots[row]];
+        for (int t = 0; t < numSteps; t++) {
+            int error = backend->position(entry, table.timeAt(t), pos);
+            table.set(row, t, pos, error == 0);
         }
     }
 }
@@ -0,0 +1,96 @@
+/****************************************************************/
+/*                          ThreadPool                          */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        Persistent worker pool. A job is published under the  */
+/*        lock with a new generation number; workers claim task */
+/*        indices with an atomic counter so uneven tasks still  */
+/*        balance, and the last worker out signals the caller.  */
+/****************************************************************/
+
+#include <thread>
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int numThreads) : nextTask(0) {
+    if (numThreads <= 0) {
+        numThreads = thread::hardware_concurrency();
+    }
+
+    for (int i = 1; i < numThreads; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::run(int numTasks, const function<void(int)>& task) {
+    if (numTasks <= 0) {
+        return;
+    }
+
+    // Not worth waking anyone, or the workers belong to another caller
+    unique_lock<mutex> owner(runLock, try_to_lock);
+    if (workers.empty() || numTasks == 1 || !owner.owns_lock()) {
+        for (int i = 0; i < numTasks; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    {
+        lock_guard<mutex> guard(lock);
+        job = &task;
+        jobTasks = numTasks;
+        nextTask.store(0);
+        activeWorkers = workers.size();
+        generation++;
+    }
+    wake.notify_all();
+
+    drain();
+
+    unique_lock<mutex> guard(lock);
+    finished.wait(guard, [this] {return activeWorkers == 0;});
+    job = nullptr;
+}
+
+void ThreadPool::drain() {
+    for (int i = nextTask.fetch_add(1); i < jobTasks; i = nextTask.fetch_add(1)) {
+        (*job)(i);
+    }
+}
+
+void ThreadPool::workerLoop() {
+    unsigned long long seen = 0;
+
+    while (true) {
+        {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [&] {return stopping || generation != seen;});
+
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+
+        drain();
+
+        lock_guard<mutex> guard(lock);
+        if (--activeWorkers == 0) {
+            finished.notify_one();
+        }
+    }
+}
@@ -0,0 +1,146 @@
+/****************************************************************/
+/*                          TleHistory                          */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        Time-sorted element set index for replay across       */
+/*        several archives.                                     */
+/****************************************************************/
+
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+#include <unordered_map>
+
+#include "TleHistory.h"
+#include "SatelliteCatalog.h"
+
+void TleHistory::build(const TleElements* elements, int count) {
+    vector<int> order(count);
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        if (elements[a].satNum != elements[b].satNum) {
+            return elements[a].satNum < elements[b].satNum;
+        }
+        return elements[a].epochDs50UTC < elements[b].epochDs50UTC;
+    });
+
+    sets.clear();
+    epochs.clear();
+    sets.reserve(count);
+    epochs.reserve(count);
+
+    for (int i : order) {
+        const TleElements& el = elements[i];
+        if (!sets.empty() && sets.back().satNum == el.satNum && sets.back().epochDs50UTC == el.epochDs50UTC) {
+            continue;
+        }
+
+        sets.push_back(el);
+        epochs.push_back(el.epochDs50UTC);
+    }
+
+    slotBegin.clear();
+    slotEnd.clear();
+    currentSet.clear();
+    switches.clear();
+    cursor = -1;
+}
+
+void TleHistory::bind(const vector<int>& slotIds, double analysisTime) {
+    // First set of every object
+    unordered_map<int, int> firstById;
+    for (int i = 0; i < (int)sets.size(); i++) {
+        firstById.emplace(sets[i].satNum, i);
+    }
+
+    int numSlots = slotIds.size();
+    slotBegin.assign(numSlots, 0);
+    slotEnd.assign(numSlots, 0);
+    currentSet.assign(numSlots, -1);
+    visited.assign(numSlots, 0);
+    switches.clear();
+
+    for (int slot = 0; slot < numSlots; slot++) {
+        auto found = firstById.find(slotIds[slot]);
+        if (found == firstById.end()) {
+            continue;
+        }
+
+        int begin = found->second;
+        int end = begin;
+        while (end < (int)sets.size() && sets[end].satNum == slotIds[slot]) {
+            end++;
+        }
+
+        slotBegin[slot] = begin;
+        slotEnd[slot] = end;
+        currentSet[slot] = analysisTime == SELECT_NEWEST_EPOCH ? end - 1 : nearest(slot, analysisTime);
+
+        for (int i = begin; i + 1 < end; i++) {
+            switches.emplace_back(0.5 * (epochs[i] + epochs[i + 1]), slot);
+        }
+    }
+
+    sort(switches.begin(), switches.end());
+    cursor = -1;
+}
+
+int TleHistory::nearest(int slot, double ds50UTC) const {
+    int begin = slotBegin[slot];
+    int end = slotEnd[slot];
+
+    if (begin == end) {
+        return -1;
+    }
+
+    // First set after ds50UTC, then whichever neighbour is closer
+    int after = upper_bound(epochs.begin() + begin, epochs.begin() + end, ds50UTC) - epochs.begin();
+
+    if (after == begin) {
+        return begin;
+    }
+    if (after == end) {
+        return end - 1;
+    }
+
+    return ds50UTC - epochs[after - 1] < epochs[after] - ds50UTC ? after - 1 : after;
+}
+
+bool TleHistory::recheck(int slot, double ds50UTC, vector<int>& switched) {
+    int best = nearest(slot, ds50UTC);
+
+    if (best == currentSet[slot]) {
+        return false;
+    }
+
+    currentSet[slot] = best;
+    switched.push_back(slot);
+    return true;
+}
+
+int TleHistory::update(double ds50UTC, vector<int>& switched) {
+    int numSwitched = 0;
+    int next = upper_bound(switches.begin(), switches.end(), make_pair(ds50UTC, (int)currentSet.size())) - switches.begin();
+
+    if (cursor < 0 || abs(next - cursor) > (int)currentSet.size()) {
+        // First update or a long jump: cheaper to look at every slot once
+        for (int slot = 0; slot < (int)currentSet.size(); slot++) {
+            numSwitched += recheck(slot, ds50UTC, switched);
+        }
+    } else {
+        // Playback: only objects with a switch point between the two times can change,
+        // and one that crossed several is still re-checked once
+        stamp++;
+        for (int i = min(cursor, next); i < max(cursor, next); i++) {
+            int slot = switches[i].second;
+            if (visited[slot] != stamp) {
+                visited[slot] = stamp;
+                numSwitched += recheck(slot, ds50UTC, switched);
+            }
+        }
+    }
+
+    cursor = next;
+    return numSwitched;
+}
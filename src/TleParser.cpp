@@ -0,0 +1,178 @@
+/****************************************************************/
+/*                           TleParser                          */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        Two passes over the buffer: count the element sets    */
+/*        in each chunk, then parse every chunk into its slice  */
+/*        of the preallocated output. Whether a line starts a   */
+/*        set depends only on it and the next line, so chunks   */
+/*        agree with a serial scan wherever they are cut.       */
+/****************************************************************/
+
+#include <algorithm>
+#include <cstring>
+
+#include "TleParser.h"
+
+namespace {
+
+// Smallest amount of text worth handing to its own task
+const size_t MIN_CHUNK_BYTES = 64 * 1024;
+
+struct ChunkResult {
+    int count = 0;
+    int malformed = 0;
+    int badChecksum = 0;
+    int filtered = 0;
+    const char* firstError = nullptr;
+    int firstErrorLength = 0;
+};
+
+inline const char* findLineEnd(const char* p, const char* end) {
+    const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+    return eol != nullptr ? eol : end;
+}
+
+inline int lineLength(const char* p, const char* eol) {
+    while (eol > p && eol[-1] == '\r') {
+        eol--;
+    }
+    return eol - p;
+}
+
+// First line start at or after offset
+const char* alignToLine(const char* data, size_t offset, const char* end) {
+    if (offset == 0) {
+        return data;
+    }
+
+    const char* eol = findLineEnd(data + offset - 1, end);
+    return eol < end ? eol + 1 : end;
+}
+
+// Call visit(line1, len1, line2, len2) for every set whose line 1 starts in [begin, stop)
+template <typename Visit>
+void scanSets(const char* begin, const char* stop, const char* end, Visit visit) {
+    const char* p = begin;
+
+    while (p < stop) {
+        const char* eol = findLineEnd(p, end);
+        const char* next = eol < end ? eol + 1 : end;
+
+        if (*p == '1' && next < end && *next == '2') {
+            const char* eol2 = findLineEnd(next, end);
+            visit(p, lineLength(p, eol), next, lineLength(next, eol2));
+            p = eol2 < end ? eol2 + 1 : end;
+        } else {
+            p = next;
+        }
+    }
+}
+
+} // namespace
+
+TleParseStats parseTleBuffer(const char* data, size_t size, vector<TleElements>& elements, ThreadPool* pool,
+                             const CatalogFilter* filter) {
+    TleParseStats stats;
+
+    if (data == nullptr || size == 0) {
+        return stats;
+    }
+
+    const char* end = data + size;
+
+    int numChunks = 1;
+    if (pool != nullptr) {
+        numChunks = (int)min<size_t>(pool->size() * 4, max<size_t>(size / MIN_CHUNK_BYTES, 1));
+    }
+
+    vector<const char*> bounds(numChunks + 1);
+    for (int c = 0; c < numChunks; c++) {
+        bounds[c] = alignToLine(data, size / numChunks * c, end);
+    }
+    bounds[numChunks] = end;
+
+    vector<ChunkResult> results(numChunks);
+    auto forEachChunk = [&](const function<void(int)>& task) {
+        if (pool != nullptr) {
+            pool->run(numChunks, task);
+        } else {
+            for (int c = 0; c < numChunks; c++) {
+                task(c);
+            }
+        }
+    };
+
+    // Pass 1: count
+    forEachChunk([&](int c) {
+        int count = 0;
+        scanSets(bounds[c], bounds[c + 1], end, [&](const char*, int, const char*, int) {count++;});
+        results[c].count = count;
+    });
+
+    size_t base = elements.size();
+    vector<size_t> offsets(numChunks + 1, base);
+    for (int c = 0; c < numChunks; c++) {
+        offsets[c + 1] = offsets[c] + results[c].count;
+    }
+
+    elements.resize(offsets[numChunks]);
+    vector<unsigned char> valid(offsets[numChunks] - base, 1);
+
+    // Pass 2: parse in place
+    forEachChunk([&](int c) {
+        ChunkResult& result = results[c];
+        size_t i = offsets[c];
+
+        scanSets(bounds[c], bounds[c + 1], end, [&](const char* line1, int len1, const char* line2, int len2) {
+            bool ok = true;
+
+            if (!tleChecksumValid(line1, len1) || !tleChecksumValid(line2, len2)) {
+                result.badChecksum++;
+                ok = false;
+            } else if (!parseTleLines(line1, len1, line2, len2, elements[i])) {
+                result.malformed++;
+                ok = false;
+            }
+
+            if (!ok) {
+                valid[i - base] = 0;
+                if (result.firstError == nullptr) {
+                    result.firstError = line1;
+                    result.firstErrorLength = len1;
+                }
+            } else if (filter != nullptr && !filter->accepts(elements[i])) {
+                valid[i - base] = 0;
+                result.filtered++;
+            }
+
+            i++;
+        });
+    });
+
+    for (const ChunkResult& result : results) {
+        stats.malformed += result.malformed;
+        stats.badChecksum += result.badChecksum;
+        stats.filtered += result.filtered;
+        if (stats.firstError == nullptr) {
+            stats.firstError = result.firstError;
+            stats.firstErrorLength = result.firstErrorLength;
+        }
+    }
+
+    // Close the gaps left by rejected and filtered sets without reordering
+    if (stats.malformed + stats.badChecksum + stats.filtered > 0) {
+        size_t kept = base;
+        for (size_t i = base; i < elements.size(); i++) {
+            if (valid[i - base]) {
+                elements[kept++] = elements[i];
+            }
+        }
+        elements.resize(kept);
+    }
+
+    stats.sets = elements.size() - base;
+
+    return stats;
+}
@@ -0,0 +1,124 @@
+/****************************************************************/
+/*                         WindowScreener                       */
+/*                                                              */
+/*                           Blake Owen                         */
+/*                                                              */
+/*        Work is split by sorted shell position, so a task     */
+/*        owns whole candidate windows and needs no locking.    */
+/****************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#include "WindowScreener.h"
+
+namespace {
+
+// Sorted shell positions per task; windows of low orbits are long, so keep tasks small
+const int WINDOW_CHUNK = 256;
+
+bool compareConjunctionMiss(const Conjunction& a, const Conjunction& b) {
+    return a.missKm < b.missKm;
+}
+
+} // namespace
+
+void screenWindow(const EphemerisTable& table, const vector<int>& rows, const OrbitShellFilter& shells,
+                  double toleranceKm, vector<Conjunction>& conjunctions, ThreadPool* pool,
+                  const atomic<bool>* cancel) {
+    conjunctions.clear();
+
+    int n = shells.size();
+    int numRows = table.satCount();
+    int numSteps = table.stepCount();
+    if ((int)rows.size() != numRows) {
+        std::cout << "[ERROR]: " << rows.size() << " row indices for an ephemeris table of " << numRows << std::endl;
+        return;
+    }
+
+    vector<int> rowOf(n, -1);
+    for (int r = 0; r < numRows; r++) {
+        rowOf[rows[r]] = r;
+    }
+
+    // Entry (row, t) is at index(row, 0) + t * stride in either layout
+    size_t stride = table.getLayout() == EPHEM_SAT_MAJOR ? 1 : numRows;
+    const double* positions = table.data();
+    const unsigned char* valid = table.validity();
+    double tolerance2 = toleranceKm * toleranceKm;
+
+    int numChunks = (n + WINDOW_CHUNK - 1) / WINDOW_CHUNK;
+    vector<vector<Conjunction>> chunkResults(numChunks);
+
+    auto task = [&](int c) {
+        // One window at a time; a low orbit's window alone can hold most of the catalog
+        vector<pair<int, int>> pairs;
+        int end = min(n, (c + 1) * WINDOW_CHUNK);
+        for (int k = c * WINDOW_CHUNK; k < end; k++) {
+            if (cancel != nullptr && *cancel) {
+                return;
+            }
+
+            pairs.clear();
+            shells.candidates(k, k + 1, pairs);
+
+            for (const pair<int, int>& candidate : pairs) {
+                int rowA = rowOf[candidate.first];
+                int rowB = rowOf[candidate.second];
+                if (rowA < 0 || rowB < 0) {
+                    continue;
+                }
+
+                size_t baseA = table.index(rowA, 0);
+                size_t baseB = table.index(rowB, 0);
+
+                double best = numeric_limits<double>::max();
+                int bestStep = -1;
+                for (int t = 0; t < numSteps; t++) {
+                    size_t ia = baseA + t * stride;
+                    size_t ib = baseB + t * stride;
+                    if (!valid[ia] || !valid[ib]) {
+                        continue;
+                    }
+
+                    double dx = positions[ia * 3] - positions[ib * 3];
+                    double dy = positions[ia * 3 + 1] - positions[ib * 3 + 1];
+                    double dz = positions[ia * 3 + 2] - positions[ib * 3 + 2];
+                    double dist2 = dx * dx + dy * dy + dz * dz;
+                    if (dist2 < best && !is_same_object(dist2)) {
+                        best = dist2;
+                        bestStep = t;
+                    }
+                }
+
+                if (bestStep >= 0 && best <= tolerance2) {
+                    Conjunction conjunction;
+                    conjunction.first = candidate.first;
+                    conjunction.second = candidate.second;
+                    conjunction.missKm = sqrt(best);
+                    conjunction.step = bestStep;
+                    chunkResults[c].push_back(conjunction);
+                }
+            }
+        }
+    };
+
+    if (pool != nullptr) {
+        pool->run(numChunks, task);
+    } else {
+        for (int c = 0; c < numChunks; c++) {
+            task(c);
+        }
+    }
+
+    if (cancel != nullptr && *cancel) {
+        return;
+    }
+
+    for (const vector<Conjunction>& chunk : chunkResults) {
+        conjunctions.insert(conjunctions.end(), chunk.begin(), chunk.end());
+    }
+    sort(conjunctions.begin(), conjunctions.end(), compareConjunctionMiss);
+}
@@ -1,9 +1,24 @@
 #include "OpenGLEngine.h"
 
-int main()
+int main(int argc, char* argv[])
 {
     OpenGLEngine engine;
 
+    // Optional TLE sources: files, directories or patterns such as "archive/2023_*.txt",
+    // --filter "perigee<2000 incl=50..60" to load only part of the catalog, and
+    // --profile startup.json to also write the startup phase timings as JSON
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--filter" && i + 1 < argc) {
+            if (!engine.setCatalogFilter(argv[++i])) {
+                return EXIT_FAILURE;
+            }
+        } else if (string(argv[i]) == "--profile" && i + 1 < argc) {
+            engine.setStartupProfileFile(argv[++i]);
+        } else {
+            engine.addTleSource(argv[i]);
+        }
+    }
+
     engine.init();
 
     engine.mainEventLoop();